@@ -0,0 +1,61 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef BLACK_FRONTEND_BINARY_TRACE_HPP
+#define BLACK_FRONTEND_BINARY_TRACE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace black::frontend 
+{
+  //
+  // Binary trace files, as written by `black solve -o binary` and read by 
+  // `black check`, are laid out as follows, with little-endian integers:
+  //
+  // - the magic string "BLACKTRC" and the format version, as one byte
+  // - the result of the solver, as one byte: 0 for UNKNOWN, 1 for SAT and 
+  //   2 for UNSAT
+  // - the number of atoms, on 4 bytes, followed by their names, each one
+  //   given by its length, on 4 bytes, and its characters
+  // - the number of states and the index of the state the last one loops 
+  //   back to, on 8 bytes each. Finite models have `binary_trace_no_loop`
+  //   in place of the loop index, as JSON traces have no "loop" field.
+  // - the states, each one on (atoms + 3) / 4 bytes holding 2 bits for each 
+  //   atom, in the order of the names, starting from the least significant
+  //   bits: 00 for undefined, 01 for false and 11 for true
+  //
+  inline constexpr std::string_view binary_trace_magic = "BLACKTRC";
+  inline constexpr uint8_t binary_trace_version = 1;
+  inline constexpr uint64_t binary_trace_no_loop = ~uint64_t{0};
+
+  // appends `n` to `buffer` as a little-endian integer of `bytes` bytes
+  inline void put_uint(std::string &buffer, uint64_t n, size_t bytes) {
+    for(size_t i = 0; i < bytes; ++i)
+      buffer += static_cast<char>((n >> (8 * i)) & 0xFF);
+  }
+}
+
+#endif // BLACK_FRONTEND_BINARY_TRACE_HPP
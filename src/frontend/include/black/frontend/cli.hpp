@@ -24,8 +24,11 @@
 #ifndef BLACK_CLI_HPP
 #define BLACK_CLI_HPP
 
+#include <black/sat/solver.hpp>
+
 #include <string>
 #include <optional>
+#include <vector>
 #include <cstdint>
 
 namespace black::frontend
@@ -67,15 +70,30 @@ namespace black::frontend
     // formula to solve, directly passed on the command line
     inline std::optional<std::string> formula;
 
+    // formulas to check against the trace, in trace checking mode
+    inline std::vector<std::string> formulas;
+
     // maximum bound for BMC algorithms, if given
     inline std::optional<size_t> bound;
 
     // name of the selected SAT backend (nullopt for default)
     inline std::optional<std::string> sat_backend;
 
+    // IPASIR solver library to register as a backend, as `name=library`
+    inline std::optional<std::string> ipasir;
+
+    // file where to record the calls to the SAT backend, in iCNF format
+    inline std::optional<std::string> record;
+
+    // tuning options for the SAT backend, given as `-O name=value`
+    inline black::sat::options sat_options;
+
     // past removing before executing the SAT-encoding (disabled by default)
     inline bool remove_past = false;
 
+    // polarity-aware CNF definitions with DIMACS-based backends
+    inline bool polarity_cnf = false;
+
     // set whether formulas are to be interpreted as LTLf
     inline bool finite = false;
 
@@ -85,9 +103,18 @@ namespace black::frontend
     // whether we are in trace checking mode
     inline bool trace_checking = false;
 
-    // the input trace to be checked
+    // whether we are in monitoring mode
+    inline bool monitoring = false;
+
+    // the input trace to be checked, or the events to monitor
     inline std::string trace;
 
+    // file or directory listing the traces to check in batch mode
+    inline std::optional<std::string> batch;
+
+    // number of threads used in batch mode (nullopt for one per core)
+    inline std::optional<size_t> jobs;
+
     // the expected result when doing trace checking
     inline std::optional<std::string> expected_result;
 
@@ -24,6 +24,8 @@
 #ifndef BLACK_FRONTEND_SUPPORT_HPP
 #define BLACK_FRONTEND_SUPPORT_HPP
 
+#include <black/sat/backends/recorder.hpp>
+
 #include <fstream>
 #include <string>
 #include <type_traits>
@@ -73,6 +75,20 @@ namespace black::frontend
     return file;
   }
 
+  //
+  // Reports the errors raised while recording the calls to the SAT backend,
+  // if `--record` is given
+  //
+  inline void check_recording() {
+    if(!cli::record)
+      return;
+
+    if(auto error = sat::backends::recorder::error(*cli::record); error)
+      io::fatal(status_code::filesystem_error,
+        "Unable to record the calls to the SAT backend: {}", *error
+      );
+  }
+
   inline
   std::function<void(std::string)> 
   formula_syntax_error_handler(std::optional<std::string> const&path)
@@ -92,10 +108,10 @@ namespace black::frontend
       quit(status_code::syntax_error);
     };
 
-    if(!cli::output_format || cli::output_format == "readable")
-      return readable_syntax_error;
+    if(cli::output_format == "json")
+      return json_syntax_error;
     
-    return json_syntax_error;
+    return readable_syntax_error;
   }
 }
 
@@ -26,9 +26,16 @@
 #include <black/sat/solver.hpp>
 #include <black/support/config.hpp>
 #include <black/support/license.hpp>
+#include <black/sat/backends/recorder.hpp>
+
+#ifdef BLACK_IPASIR_BACKEND
+  #include <black/sat/backends/ipasir.hpp>
+#endif
 
 #include <clipp.h>
 
+#include <charconv>
+
 //
 // Plug into the Clipp arguments conversion code to support std::optional vars
 //
@@ -68,6 +75,8 @@ namespace black::frontend
     io::println("{}", black::license);
     for(auto name : black::sat::solver::backends()) {
       auto backend = black::sat::solver::get_solver(name);
+      if(!backend)
+        continue;
       if(auto l = backend->license(); l) {
         io::println("{}", sep);
         io::println("{}", *l);
@@ -94,16 +103,107 @@ namespace black::frontend
     io::println("\nAvailable SAT backends:");
     for(auto backend : black::sat::solver::backends()) {
       bool star = backend == BLACK_DEFAULT_BACKEND;
-      io::println(" - {} {}", backend, star ? "*" : "");
+      if(black::sat::solver::backend_exists(backend))
+        io::println(" - {} {}", backend, star ? "*" : "");
+      else
+        io::println(" - {} (unable to load)", backend);
+    }
+  }
+
+  static bool is_ipasir_spec(std::string const &arg) {
+    size_t eq = arg.find('=');
+    return eq != std::string::npos && eq > 0 && eq + 1 < arg.size();
+  }
+
+  // registers the IPASIR backend given with `--ipasir name=library`, if any
+  static void register_ipasir_backend() {
+    if(!cli::ipasir)
+      return;
+
+#ifdef BLACK_IPASIR_BACKEND
+    size_t eq = cli::ipasir->find('=');
+    std::string name = cli::ipasir->substr(0, eq);
+    std::string library = cli::ipasir->substr(eq + 1);
+
+    auto error = 
+      black::sat::backends::ipasir::register_backend(name, library);
+    if(error) {
+      command_line_error(
+        fmt::format("unable to load IPASIR backend '{}': {}", name, *error)
+      );
+      quit(status_code::command_line_error);
     }
+#else
+    command_line_error("IPASIR backend support not available");
+    quit(status_code::command_line_error);
+#endif
   }
 
-  static bool is_backend(std::string const &name) {
-    return black::sat::solver::backend_exists(name);
+  static bool is_option_spec(std::string const &arg) {
+    size_t eq = arg.find('=');
+    return eq != std::string::npos && eq > 0;
+  }
+
+  // parses the value of a SAT option as an integer or a boolean if possible
+  static black::sat::option_value parse_option_value(std::string const& str) 
+  {
+    if(str == "true" || str == "false")
+      return str == "true";
+
+    int64_t n = 0;
+    auto [end, err] = std::from_chars(str.data(), str.data() + str.size(), n);
+    if(err == std::errc{} && end == str.data() + str.size())
+      return n;
+
+    return str;
+  }
+
+  // parses the `-O name=value` options and checks them against the backend
+  static void parse_sat_options(std::vector<std::string> const& specs) {
+    if(specs.empty())
+      return;
+
+    std::string backend = 
+      cli::sat_backend ? *cli::sat_backend : BLACK_DEFAULT_BACKEND;
+    auto solver = black::sat::solver::get_solver(backend);
+
+    for(std::string const& spec : specs) {
+      size_t eq = spec.find('=');
+      std::string name = spec.substr(0, eq);
+      black::sat::option_value value = parse_option_value(spec.substr(eq + 1));
+
+      if(!solver->set_option(name, value)) {
+        command_line_error(fmt::format(
+          "invalid option '{}' for SAT backend '{}'", spec, backend
+        ));
+        quit(status_code::command_line_error);
+      }
+
+      cli::sat_options.insert_or_assign(name, value);
+    }
+  }
+
+  // wraps the selected backend to record its calls if `--record` is given
+  static void register_recorder() {
+    if(!cli::record)
+      return;
+
+    std::string backend = 
+      cli::sat_backend ? *cli::sat_backend : BLACK_DEFAULT_BACKEND;
+    
+    auto error = black::sat::backends::recorder::register_backend(
+      "recorder", backend, *cli::record
+    );
+    if(error) {
+      command_line_error(*error);
+      quit(status_code::command_line_error);
+    }
+
+    cli::sat_backend = "recorder";
   }
 
   static bool is_output_format(std::string const &format) {
-    return format == "readable" || format == "json";
+    return format == "readable" || format == "json" || format == "binary";
   }
 
   //
@@ -116,16 +216,31 @@ namespace black::frontend
     bool help = false;
     bool version = false;
     bool show_backends = false;
+    std::vector<std::string> sat_options;
 
     auto cli = "solving mode: " % (
       command("solve"),
       (option("-k", "--bound") & integer("bound", cli::bound))
         % "maximum bound for BMC procedures",
       (option("-B", "--sat-backend") 
-        & value(is_backend, "backend", cli::sat_backend))
+        & value("backend", cli::sat_backend))
         % "select the SAT backend to use",
+      (option("--ipasir") 
+        & value(is_ipasir_spec, "name=library", cli::ipasir))
+        % "load an IPASIR-compliant SAT solver from the given shared "
+          "library, and register it as a backend with the given name",
+      (option("--record") & value("file", cli::record))
+        % "record the calls to the SAT backend into the given file, "
+          "in iCNF format",
+      repeatable(option("-O", "--sat-option") 
+        & value(is_option_spec, "name=value", sat_options))
+        % "set a tuning option of the SAT backend.\n"
+          "Options: threads, seed, memory (in MB)",
       option("--remove-past").set(cli::remove_past)
         % "translate LTL+Past formulas into LTL before checking satisfiability",
+      option("--polarity-cnf").set(cli::polarity_cnf)
+        % "with DIMACS-based backends, define the subformulas of the "
+          "encoding only in the directions required by their polarity",
       option("--finite").set(cli::finite)
         % "treat formulas as LTLf and look for finite models",
       option("-m", "--model").set(cli::print_model)
@@ -133,7 +248,7 @@ namespace black::frontend
       (option("-o", "--output-format") 
         & value(is_output_format, "fmt", cli::output_format))
         % "Output format.\n"
-          "Accepted formats: readable, json\n"
+          "Accepted formats: readable, json, binary\n"
           "Default: readable",
       (option("-f", "--formula") & value("formula", cli::formula))
         % "LTL formula to solve",
@@ -143,9 +258,19 @@ namespace black::frontend
     ) |
     "trace checking mode: " % (
       command("check").set(cli::trace_checking), 
-      (required("-t","--trace") & value("trace", cli::trace))
-        % "trace file to check against the formula.\n"
-          "If '-', reads from standard input.",
+      (
+        (required("-t","--trace") & value("trace", cli::trace))
+          % "trace file to check against the formula, in JSON or "
+            "binary format.\n"
+            "If '-', reads from standard input." |
+        (required("--batch") & value("traces", cli::batch))
+          % "check all the traces in the given directory, or listed one "
+            "per line in the given file, in parallel.\n"
+            "If '-', reads the list from standard input."
+      ),
+      (option("-j", "--jobs") & integer("n", cli::jobs))
+        % "number of threads used with --batch. "
+          "Default: one per core",
       (option("-e", "--expected") & value("result", cli::expected_result))
         % "expected result (useful in testing)",
       (option("-i", "--initial-state") & value("state", cli::initial_state))
@@ -155,17 +280,37 @@ namespace black::frontend
         % "treat formulas as LTLf and expect a finite model",
       (option("--verbose").set(cli::verbose))
         % "output a verbose log",
-      (option("-f", "--formula") & value("formula", cli::formula))
-        % "formula against which to check the trace",
+      repeatable(option("-f", "--formula") & value("formula", cli::formulas))
+        % "formula against which to check the trace. "
+          "Can be repeated to check more formulas in a single pass",
       value("file", cli::filename).required(false)
         % "formula file against which to check the trace"
+    ) | "monitoring mode: " % (
+      command("monitor").set(cli::monitoring),
+      (option("-t", "--trace") & value("events", cli::trace))
+        % "file with the states of the trace, one JSON object per line, "
+          "in the same format of the states of trace files.\n"
+          "Default: reads from standard input",
+      (option("-f", "--formula") & value("formula", cli::formula))
+        % "formula to monitor, made only of past operators, X and wX",
+      value("file", cli::filename).required(false)
+        % "formula file to monitor"
     ) | "DIMACS mode: " % (
       command("dimacs").set(cli::dimacs),
       (option("-B", "--sat-backend")
-        & value(is_backend, "backend", cli::sat_backend))
+        & value("backend", cli::sat_backend))
         % "select the SAT backend to use",
+      (option("--ipasir") 
+        & value(is_ipasir_spec, "name=library", cli::ipasir))
+        % "load an IPASIR-compliant SAT solver as a backend",
+      (option("--record") & value("file", cli::record))
+        % "record the calls to the SAT backend into the given file",
+      repeatable(option("-O", "--sat-option") 
+        & value(is_option_spec, "name=value", sat_options))
+        % "set a tuning option of the SAT backend",
       value("file", cli::filename)
-        % "DIMACS file to solve"
+        % "DIMACS file to solve.\n"
+          "iCNF files are replayed, printing the result of each solve call"
     ) | command("--sat-backends").set(show_backends) 
           % "print the list of available SAT backends"
       | command("-v", "--version").set(version)
@@ -195,5 +340,23 @@ namespace black::frontend
       print_version();
       quit(status_code::success);
     }
+
+    // backends given at runtime must be known before checking the -B option
+    register_ipasir_backend();
+
+    std::string backend = 
+      cli::sat_backend ? *cli::sat_backend : BLACK_DEFAULT_BACKEND;
+    if(!black::sat::solver::backend_exists(backend)) {
+      if(auto error = black::sat::solver::backend_error(backend); error)
+        command_line_error(fmt::format(
+          "unable to load SAT backend '{}': {}", backend, *error
+        ));
+      else
+        command_line_error(fmt::format("unknown SAT backend '{}'", backend));
+      quit(status_code::command_line_error);
+    }
+
+    parse_sat_options(sat_options);
+    register_recorder();
   }
 }
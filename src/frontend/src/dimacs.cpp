@@ -33,26 +33,30 @@
 
 namespace black::frontend {
   
-  static
-  int dimacs(std::optional<std::string> const&, std::istream &in) 
+  static int dimacs(std::optional<sat::dimacs::problem> const& problem)
   {
     using namespace black::sat;
-    
-    bool error = false;
-    std::optional<dimacs::problem> problem = 
-      dimacs::parse(in, [&](std::string str) {
-        io::println("{}: {}", cli::command_name, str);
-        error = true;
-      });
-    
-    if(error)
-      quit(status_code::syntax_error);
 
     black_assert(problem.has_value());
 
     std::string backend = 
       cli::sat_backend ? *cli::sat_backend : BLACK_DEFAULT_BACKEND;
-    std::optional<dimacs::solution> s = dimacs::solve(*problem, backend);
+
+    if(problem->incremental) {
+      std::vector<bool> results = 
+        dimacs::replay(*problem, backend, cli::sat_options);
+      check_recording();
+
+      io::println("c BLACK v{}", black::version);
+      for(bool result : results)
+        io::println("s {}", result ? "SATISFIABLE" : "UNSATISFIABLE");
+
+      return 0;
+    }
+
+    std::optional<dimacs::solution> s = 
+      dimacs::solve(*problem, backend, cli::sat_options);
+    check_recording();
 
     dimacs::print(std::cout, s);
 
@@ -60,10 +64,23 @@ namespace black::frontend {
   }
 
   int dimacs() {
+    bool error = false;
+    auto handler = [&](std::string str) {
+      io::println("{}: {}", cli::command_name, str);
+      error = true;
+    };
+
+    std::optional<sat::dimacs::problem> problem;
     if(*cli::filename == "-")
-      return dimacs(std::nullopt, std::cin);
+      problem = sat::dimacs::parse(std::cin, handler);
+    else {
+      open_file(*cli::filename); // reports filesystem errors
+      problem = sat::dimacs::parse_file(*cli::filename, handler);
+    }
+    
+    if(error)
+      quit(status_code::syntax_error);
 
-    std::ifstream file = open_file(*cli::filename);
-    return dimacs(cli::filename, file);
+    return dimacs(problem);
   }
 }
@@ -25,6 +25,7 @@
 #include <black/frontend/solve.hpp>
 #include <black/frontend/dimacs.hpp>
 #include <black/frontend/tracecheck.hpp>
+#include <black/frontend/monitor.hpp>
 
 using namespace black::frontend;
 
@@ -38,5 +39,8 @@ int main(int argc, char **argv)
   if(cli::trace_checking)
     return trace_check();
   
+  if(cli::monitoring)
+    return trace_monitor();
+  
   return solve();
 }
@@ -0,0 +1,166 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <black/frontend/monitor.hpp>
+#include <black/frontend/cli.hpp>
+#include <black/frontend/io.hpp>
+#include <black/frontend/support.hpp>
+
+#include <black/logic/alphabet.hpp>
+#include <black/logic/formula.hpp>
+#include <black/logic/parser.hpp>
+#include <black/trace/monitor.hpp>
+#include <black/support/tribool.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace black::frontend 
+{
+  //
+  // Reads the events one per line, each one being a state in the same 
+  // format as the states of trace files, and prints the verdict for each
+  // position as soon as it is determined.
+  //
+  static int trace_monitor(
+    std::optional<std::string> const&path,
+    std::istream &file,
+    std::optional<std::string> const&eventspath,
+    std::istream &events
+  ) {
+    black::alphabet sigma;
+
+    black::formula f = 
+      *black::parse_formula(sigma, file, formula_syntax_error_handler(path));
+
+    if(auto error = black::monitor::monitorable(f); error)
+      io::fatal(status_code::command_line_error, 
+        "cannot monitor the formula: {}", *error);
+
+    black::monitor mon{f};
+
+    std::unordered_map<std::string, size_t> index;
+    for(size_t i = 0; i < mon.atoms().size(); ++i)
+      index.insert({to_string(mon.atoms()[i]), i});
+
+    std::string epath = eventspath ? *eventspath : "<stdin>";
+    bool failed = false;
+    auto report = [&](size_t t, bool verdict) {
+      io::println("{}: {}", t, verdict ? "TRUE" : "FALSE");
+      failed = failed || !verdict;
+    };
+
+    std::vector<black::tribool> state(
+      mon.atoms().size(), black::tribool::undef
+    );
+    std::string line;
+    for(size_t lineno = 1; ; ++lineno) {
+      // verdicts are flushed out before waiting for more events
+      if(events.rdbuf()->in_avail() <= 0)
+        std::fflush(stdout);
+      
+      if(!std::getline(events, line))
+        break;
+
+      if(line.find_first_not_of(" \t\r") == std::string::npos)
+        continue;
+
+      json j = json::parse(line, nullptr, false);
+      if(j.is_discarded() || !j.is_object())
+        io::fatal(status_code::syntax_error, 
+          "{}:{}: invalid state", epath, lineno);
+
+      std::fill(state.begin(), state.end(), black::tribool::undef);
+      for(auto it = j.begin(); it != j.end(); ++it) {
+        auto value = it.value().is_string() ? 
+          it.value().get<std::string>() : std::string{};
+        if(value != "true" && value != "false" && value != "undef")
+          io::fatal(status_code::syntax_error,
+            "{}:{}: invalid proposition value", epath, lineno);
+
+        if(auto i = index.find(it.key()); i != index.end())
+          state[i->second] = value == "undef" ? black::tribool::undef
+                                              : black::tribool{value == "true"};
+      }
+
+      if(auto verdict = mon.step(state); verdict)
+        report(mon.size() - mon.delay() - 1, *verdict);
+    }
+
+    size_t t = mon.size() > mon.delay() ? mon.size() - mon.delay() : 0;
+    for(bool verdict : mon.finish())
+      report(t++, verdict);
+
+    quit(failed ? status_code::failed_check : status_code::success);
+  }
+
+  int trace_monitor() {
+    if(!cli::filename && !cli::formula) {
+      command_line_error("please specify a filename or the --formula option");
+      quit(status_code::command_line_error);
+    }
+
+    if(cli::filename && cli::formula) {
+      command_line_error(
+        "please specify only either a filename or the --formula option"
+      );
+      quit(status_code::command_line_error);
+    }
+
+    bool events_stdin = cli::trace.empty() || cli::trace == "-";
+    std::optional<std::string> eventspath;
+    if(!events_stdin)
+      eventspath = cli::trace;
+
+    if(cli::filename == "-" && events_stdin) {
+      command_line_error(
+        "cannot read from stdin both the formula file and the events"
+      );
+      quit(status_code::command_line_error);
+    }
+
+    std::ifstream eventsfile;
+    if(!events_stdin)
+      eventsfile = open_file(cli::trace);
+    std::istream &events = events_stdin ? std::cin : eventsfile;
+
+    if(cli::formula) {
+      std::istringstream str{*cli::formula};
+      return trace_monitor(std::nullopt, str, eventspath, events);
+    }
+
+    if(*cli::filename == "-")
+      return trace_monitor(std::nullopt, std::cin, eventspath, events);
+
+    std::ifstream file = open_file(*cli::filename);
+    return trace_monitor(cli::filename, file, eventspath, events);
+  }
+}
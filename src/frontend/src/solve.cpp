@@ -26,17 +26,27 @@
 #include <black/frontend/io.hpp>
 #include <black/frontend/cli.hpp>
 #include <black/frontend/support.hpp>
+#include <black/frontend/binary_trace.hpp>
 
 #include <black/logic/formula.hpp>
 #include <black/logic/parser.hpp>
 #include <black/logic/past_remover.hpp>
 #include <black/solver/solver.hpp>
 
+#include <cstdio>
 #include <sstream>
+#include <vector>
 
 namespace black::frontend {
 
-  void output(tribool result, solver &solver, formula f);
+  // `translated` is the size of the formula after past removal, if done
+  void output(
+    tribool result, solver &solver, formula f, 
+    std::optional<size_t> translated
+  );
+
+  // number of distinct subformulas of `f`
+  static size_t dag_size(formula f);
   
   int solve(std::optional<std::string> const&path, std::istream &file);
 
@@ -79,16 +89,26 @@ namespace black::frontend {
     if (cli::sat_backend)
       slv.set_sat_backend(*cli::sat_backend);
 
-    if (cli::remove_past)
-      slv.set_formula(black::remove_past(*f), cli::finite);
-    else
+    for(auto const& [name, value] : cli::sat_options)
+      slv.set_sat_option(name, value);
+
+    if (cli::polarity_cnf)
+      slv.set_cnf_encoding(black::cnf_encoding::plaisted_greenbaum);
+
+    std::optional<size_t> translated;
+    if (cli::remove_past) {
+      black::formula ltl = black::remove_past(*f);
+      translated = dag_size(ltl);
+      slv.set_formula(ltl, cli::finite);
+    } else
       slv.set_formula(*f, cli::finite);
 
     size_t bound = 
       cli::bound ? *cli::bound : std::numeric_limits<size_t>::max();
     black::tribool res = slv.solve(bound);
+    check_recording();
 
-    output(res, slv, *f);
+    output(res, slv, *f, translated);
 
     return 0;
   }
@@ -112,6 +132,12 @@ namespace black::frontend {
     );
   }
 
+  static std::vector<atom> relevant_atoms(formula f) {
+    std::unordered_set<atom> atoms;
+    relevant_atoms(f, atoms);
+    return {atoms.begin(), atoms.end()};
+  }
+
   static
   void readable(tribool result, solver &solver, formula f)
   {
@@ -136,34 +162,54 @@ namespace black::frontend {
     else
       io::println("Model:");
 
-    std::unordered_set<atom> atoms;
-    relevant_atoms(f, atoms);
+    auto model = solver.model()->extract(relevant_atoms(f));
     
-    size_t size = solver.model()->size();
-    size_t width = static_cast<size_t>(log10((double)size)) + 1;
-    for(size_t t = 0; t < size; ++t) {
+    size_t width = static_cast<size_t>(log10((double)model.size)) + 1;
+    for(size_t t = 0; t < model.size; ++t) {
       io::print("- t = {:>{}}: {{", t, width);
       bool first = true;
-      for(atom a : atoms) {
-        tribool v = solver.model()->value(a, t);
+      for(size_t i = 0; i < model.atoms.size(); ++i) {
+        tribool v = model.value(i, t);
         const char *comma = first ? "" : ", ";
         if(v == true) {
-          io::print("{}{}", comma, to_string(a));
+          io::print("{}{}", comma, to_string(model.atoms[i]));
           first = false;
         } else if(v == false) {
-          io::print("{}￢{}", comma, to_string(a));
+          io::print("{}￢{}", comma, to_string(model.atoms[i]));
           first = false;
         }
       }
       io::print("}}");
-      if(solver.model()->loop() == t)
+      if(model.loop == t)
         io::print(" ⬅︎ loops here");
       io::print("\n");
     }
   }
 
+  static size_t dag_size(formula f, std::unordered_set<formula> &visited) {
+    if(!visited.insert(f).second)
+      return 0;
+
+    return 1 + f.match(
+      [](boolean) -> size_t { return 0; },
+      [](atom) -> size_t { return 0; },
+      [&](unary, formula op) { return dag_size(op, visited); },
+      [&](binary, formula left, formula right) {
+        return dag_size(left, visited) + dag_size(right, visited);
+      }
+    );
+  }
+
+  static size_t dag_size(formula f) {
+    std::unordered_set<formula> visited;
+    return dag_size(f, visited);
+  }
+
   static
-  void json(tribool result, solver &solver, formula f) {
+  void json(
+    tribool result, solver &solver, formula f, 
+    std::optional<size_t> translated
+  ) {
     io::println("{{");
     
     io::println("    \"result\": \"{}\",", 
@@ -171,39 +217,42 @@ namespace black::frontend {
       result == true  ? "SAT" : "UNSAT"
     );
 
+    if(translated)
+      io::println("    \"translated_size\": {},", *translated);
+
     io::println("    \"k\": {}{}", 
       solver.last_bound(),
       cli::print_model && result == true ? "," : ""
     );
 
     if(result == true && cli::print_model) {
-      auto model = solver.model();
-      std::unordered_set<atom> atoms;
-      relevant_atoms(f, atoms);
+      auto model = solver.model()->extract(relevant_atoms(f));
 
       io::println("    \"model\": {{");
-      io::println("        \"size\": {},", model->size());
+      io::println("        \"size\": {},", model.size);
       if(!cli::finite)
-        io::println("        \"loop\": {},", model->loop());
+        io::println("        \"loop\": {},", model.loop);
 
       io::println("        \"states\": [");
 
-      for(size_t t = 0; t < model->size(); ++t) {
+      std::vector<std::string> names;
+      for(atom a : model.atoms)
+        names.push_back(to_string(a));
+
+      for(size_t t = 0; t < model.size; ++t) {
         io::println("            {{");
 
-        size_t i = 0;
-        for(atom a : atoms) {
-          tribool v = model->value(a, t);
+        for(size_t i = 0; i < model.atoms.size(); ++i) {
+          tribool v = model.value(i, t);
           io::println("                \"{}\": \"{}\"{}",
-            to_string(a),
+            names[i],
             v == tribool::undef ? "undef" :
             v == true           ? "true" : "false",
-            i < atoms.size() - 1 ? "," : ""
+            i < model.atoms.size() - 1 ? "," : ""
           );
-          ++i;
         }
 
-        io::println("            }}{}", t < model->size() - 1 ? "," : "");
+        io::println("            }}{}", t < model.size - 1 ? "," : "");
       }
 
       io::println("        ]");
@@ -214,9 +263,64 @@ namespace black::frontend {
     io::println("}}");
   }
 
-  void output(tribool result, solver &solver, formula f) {
+  // writes the model in the format described in binary_trace.hpp
+  static
+  void binary(tribool result, solver &solver, formula f) {
+    // the output is written in chunks of this size
+    constexpr size_t flush_threshold = 1 << 20;
+
+    std::string buffer{binary_trace_magic};
+    put_uint(buffer, binary_trace_version, 1);
+    put_uint(buffer, 
+      result == tribool::undef ? 0 : result == true ? 1 : 2, 1
+    );
+
+    auto flush = [&]() {
+      std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+      buffer.clear();
+    };
+
+    black::model::matrix model;
+    if(result == true && cli::print_model)
+      model = solver.model()->extract(relevant_atoms(f));
+
+    put_uint(buffer, model.atoms.size(), 4);
+    for(atom a : model.atoms) {
+      std::string name = to_string(a);
+      put_uint(buffer, name.size(), 4);
+      buffer += name;
+    }
+
+    put_uint(buffer, model.size, 8);
+    put_uint(buffer, cli::finite ? binary_trace_no_loop : model.loop, 8);
+
+    std::string state((model.atoms.size() + 3) / 4, '\0');
+    for(size_t t = 0; t < model.size; ++t) {
+      std::fill(state.begin(), state.end(), '\0');
+      for(size_t i = 0; i < model.atoms.size(); ++i) {
+        tribool v = model.value(i, t);
+        unsigned bits = v == tribool::undef ? 0b00 : v == true ? 0b11 : 0b01;
+        state[i / 4] = static_cast<char>(state[i / 4] | bits << (2 * (i % 4)));
+      }
+      buffer += state;
+
+      if(buffer.size() >= flush_threshold)
+        flush();
+    }
+
+    flush();
+    std::fflush(stdout);
+  }
+
+  void output(
+    tribool result, solver &solver, formula f, 
+    std::optional<size_t> translated
+  ) {
     if(cli::output_format == "json")
-      return json(result, solver, f);
+      return json(result, solver, f, translated);
+
+    if(cli::output_format == "binary")
+      return binary(result, solver, f);
 
     return readable(result, solver, f);
   }
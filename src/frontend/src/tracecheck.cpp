@@ -24,16 +24,24 @@
 #include <black/frontend/tracecheck.hpp>
 #include <black/frontend/io.hpp>
 #include <black/frontend/support.hpp>
+#include <black/frontend/binary_trace.hpp>
 
 #include <black/logic/alphabet.hpp>
 #include <black/logic/formula.hpp>
 #include <black/logic/parser.hpp>
-#include <black/logic/past_remover.hpp>
+#include <black/trace/trace.hpp>
+#include <black/trace/checker.hpp>
 #include <black/support/tribool.hpp>
 
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
@@ -41,394 +49,669 @@ using json = nlohmann::json;
 
 namespace black::frontend 
 {
-  using state_t = std::map<std::string, black::tribool>;
-
-  struct trace_t {
+  //
+  // A trace as read from a trace file, together with the result of the
+  // solver that produced it
+  //
+  struct trace_file {
     std::optional<std::string> result;
-    size_t loop = 0;
-    std::vector<state_t> states;
+    black::trace model;
   };
 
-  static bool check(trace_t, formula, size_t);
+  //
+  // Outcome of checking a trace, i.e. the message to print to the user
+  // and the corresponding status code
+  //
+  struct verdict {
+    std::string message;
+    status_code status = status_code::success;
+    bool error = false;
+  };
 
-  static
-  std::optional<state_t> state_at(trace_t trace, size_t t) {
-    if(t < trace.loop)
-      return trace.states[t];
-    
-    size_t period = trace.states.size() - trace.loop;
+  using trace_error_handler = std::function<void(std::string)>;
+
+  //
+  // SAX handler that reads a trace file into a trace_file, building the 
+  // compact trace representation as the states are read. This avoids to 
+  // materialize the whole JSON document, so memory usage stays close to 
+  // the size of the packed trace.
+  //
+  class trace_reader 
+  {
+  public:
+    using number_integer_t = json::number_integer_t;
+    using number_unsigned_t = json::number_unsigned_t;
+    using number_float_t = json::number_float_t;
+    using string_t = json::string_t;
+
+    trace_reader(trace_file &trace) : _trace{trace} { }
+
+    // validates the fields read from the file, after a successful parse
+    std::optional<std::string> finish();
+
+    // error message, if reading has been aborted
+    std::optional<std::string> const&error() const { return _error; }
 
-    if(period)
-      return trace.states[((t - trace.loop) % period) + trace.loop];
+    bool null() { return scalar(std::nullopt, true); }
+    bool boolean(bool) { return scalar(std::nullopt); }
+    bool number_integer(number_integer_t n) { 
+      return n < 0 ? scalar(std::nullopt) : number_unsigned(uint64_t(n));
+    }
+    bool number_unsigned(number_unsigned_t n) { return scalar(n); }
+    bool number_float(number_float_t, string_t const&) {
+      return scalar(std::nullopt);
+    }
+    bool string(string_t &str);
+#if NLOHMANN_JSON_VERSION_MAJOR > 3 || NLOHMANN_JSON_VERSION_MINOR >= 8
+    bool binary(json::binary_t &) { return scalar(std::nullopt); }
+#endif
+
+    bool start_object(size_t);
+    bool key(string_t &k);
+    bool end_object();
+    bool start_array(size_t);
+    bool end_array();
+
+    bool parse_error(size_t, std::string const&, json::exception const&ex) {
+      return fail(ex.what());
+    }
+
+  private:
+    // where we are in the document
+    enum class place {
+      top,    // the top-level object
+      model,  // the "model" object
+      states, // the "states" array
+      state,  // an element of the "states" array
+    };
+
+    bool fail(std::string message) {
+      _error = std::move(message);
+      return false;
+    }
+
+    // handles any scalar value, given as a number if it is one
+    bool scalar(std::optional<uint64_t> n, bool null = false);
+
+    // whether the current value is part of a subtree we do not care about
+    bool skipping() const { return _skip > 0; }
+
+    trace_file &_trace;
+    std::vector<place> _places;
+    std::string _key;
+    size_t _skip = 0;
     
-    black_assert(t >= trace.states.size());
-    return {};
+    std::optional<uint64_t> _size;
+    std::optional<uint64_t> _loop;
+    bool _has_model = false;
+    std::optional<std::string> _error;
+  };
+
+  bool trace_reader::scalar(std::optional<uint64_t> n, bool null) {
+    if(skipping() || _places.empty())
+      return skipping() || fail("the trace must be an object");
+
+    switch(_places.back()) {
+      case place::top:
+        if((_key == "result" || _key == "model") && !null)
+          return fail(fmt::format("invalid \"{}\" field", _key));
+        return true;
+      case place::model:
+        if(_key == "size") {
+          if(!n)
+            return fail("invalid \"size\" field");
+          _size = n;
+        } else if(_key == "loop")
+          _loop = n;
+        return true;
+      case place::states:
+        return fail("invalid state");
+      case place::state:
+        return fail("invalid proposition value");
+    }
+    black_unreachable();
   }
 
-  static
-  bool check_atom(trace_t trace, atom a, size_t t) {
-    black_assert(a.label<std::string>().has_value());
-    std::string p = *a.label<std::string>();
+  bool trace_reader::string(string_t &str) {
+    if(skipping() || _places.empty())
+      return scalar(std::nullopt);
 
-    std::optional<state_t> state = state_at(trace, t);
-    
-    // all the states at the end of a non-looping model are
-    // full of don't cares so we return true (we may choose false as well)
-    if(!state.has_value())
-      return true;
-      
-    auto it = state->find(p);
-    if(it == state->end())
+    if(_places.back() == place::top && _key == "result") {
+      _trace.result = std::move(str);
       return true;
+    }
     
-    black::tribool value = it->second;
-    if(value == true || value == black::tribool::undef)
+    if(_places.back() != place::state)
+      return scalar(std::nullopt);
+
+    black::tribool value = black::tribool::undef;
+    if(str == "undef")
+      value = black::tribool::undef;
+    else if(str == "true")
+      value = true;
+    else if(str == "false")
+      value = false;
+    else
+      return fail("invalid proposition value");
+
+    black::trace &t = _trace.model;
+    t.set(t.intern(_key), t.size() - 1, value);
+    return true;
+  }
+
+  bool trace_reader::start_object(size_t) {
+    if(skipping()) {
+      _skip++;
       return true;
+    }
 
-    return false;
-  }
+    if(_places.empty()) {
+      _places.push_back(place::top);
+      return true;
+    }
 
-  static
-  std::optional<size_t>
-  find_one(trace_t trace, formula f, size_t begin, size_t end) {
-    for(size_t i = begin; i < end; ++i) {
-      if(check(trace, f, i))
-        return i;
+    switch(_places.back()) {
+      case place::top:
+        if(_key == "model") {
+          _has_model = true;
+          _places.push_back(place::model);
+        } else if(_key == "result")
+          return fail("invalid \"result\" field");
+        else
+          _skip = 1;
+        return true;
+      case place::model:
+        if(_key == "size" || _key == "loop" || _key == "states")
+          return fail(fmt::format("invalid \"{}\" field", _key));
+        _skip = 1;
+        return true;
+      case place::states:
+        _trace.model.push_state();
+        _places.push_back(place::state);
+        return true;
+      case place::state:
+        return fail("invalid proposition value");
     }
-    return {};
+    black_unreachable();
   }
 
-  static
-  std::optional<size_t>
-  find_one_reverse(trace_t trace, formula f, size_t begin, size_t end) {
-    for(ssize_t i = (ssize_t)begin; i >= (ssize_t)end; --i) {
-      if(check(trace, f, (size_t)i))
-        return i;
-    }
-    return {};
+  bool trace_reader::key(string_t &k) {
+    if(!skipping())
+      _key = std::move(k);
+    return true;
   }
 
-  static
-  bool check_for_all(trace_t trace, formula f, size_t begin, size_t end) {
-    for(size_t i = begin; i < end; ++i) {
-      if(!check(trace, f, i))
-        return false;
-    }
+  bool trace_reader::end_object() {
+    if(skipping())
+      _skip--;
+    else
+      _places.pop_back();
     return true;
   }
 
-  static
-  size_t depth(formula f) {
-    return f.match(
-      [](boolean) -> size_t { return 1; },
-      [](atom) -> size_t { return 1; },
-      [](yesterday, formula op) { return 1 + depth(op); },
-      [](w_yesterday, formula op) { return 1 + depth(op); },
-      [](once, formula op) { return 1 + depth(op); },
-      [](historically, formula op) { return 1 + depth(op); },
-      [](since, formula l, formula r) {
-        return 1 + std::max(depth(l), depth(r));
-      },
-      [](triggered, formula l, formula r) {
-        return 1 + std::max(depth(l), depth(r));
-      },
-      [](unary, formula op) {
-        return depth(op);
-      },
-      [](binary, formula l, formula r) {
-        return std::max(depth(l), depth(r));
-      }
-    );
+  bool trace_reader::start_array(size_t) {
+    if(skipping()) {
+      _skip++;
+      return true;
+    }
+
+    if(_places.empty())
+      return fail("the trace must be an object");
+
+    switch(_places.back()) {
+      case place::top:
+        if(_key == "result" || _key == "model")
+          return fail(fmt::format("invalid \"{}\" field", _key));
+        _skip = 1;
+        return true;
+      case place::model:
+        if(_key == "states") {
+          _places.push_back(place::states);
+          return true;
+        }
+        if(_key == "size" || _key == "loop")
+          return fail(fmt::format("invalid \"{}\" field", _key));
+        _skip = 1;
+        return true;
+      case place::states:
+        return fail("invalid state");
+      case place::state:
+        return fail("invalid proposition value");
+    }
+    black_unreachable();
   }
 
-  static
-  bool check_until(trace_t trace, until u, size_t t) {
-    formula l = u.left();
-    formula r = u.right();
+  bool trace_reader::end_array() {
+    if(skipping())
+      _skip--;
+    else
+      _places.pop_back();
+    return true;
+  }
 
-    size_t period = trace.states.size() - trace.loop;
-    size_t d = depth(u);
-    black_assert(d >= 1);
+  std::optional<std::string> trace_reader::finish() {
+    if(!_has_model)
+      return {};
 
-    size_t end = std::max(t, trace.states.size()) + period + (period * d);
+    if(cli::finite && _loop)
+      return "expected a finite model, but a \"loop\" field is present";
 
-    // search for 'r'
-    std::optional<size_t> rindex = find_one(trace, r, t, end);
-    
-    if(!rindex.has_value())
-      return false; // we didn't find 'r', the formula is false
+    if(_trace.model.size() == 0)
+      return "empty model";
 
-    // check 'l' in all positions until 'r'
-    return check_for_all(trace, l, t, *rindex);
-  }
+    if(!cli::finite && !_loop)
+      return "missing or invalid \"loop\" field";
 
-  static
-  bool check_since(trace_t trace, since s, size_t t) {
-    formula l = s.left();
-    formula r = s.right();
-    
-    // search for 'r'
-    std::optional<size_t> rindex = find_one_reverse(trace, r, t, 0);
+    if(_size != _trace.model.size())
+      return "\"size\" field and effective model size disagree";
 
-    if(!rindex.has_value())
-      return false; // we didn't find 'r', the formula is false
+    _trace.model.loop = cli::finite ? *_size : *_loop;
+    if(_trace.model.loop > _trace.model.size())
+      return "\"loop\" field greater than model size";
 
-    // check 'l' in all positions until 'r'
-    return check_for_all(trace, l, *rindex + 1, t + 1);
+    return {};
   }
 
-  static
-  bool state_exists(trace_t trace, size_t t) {
-    return !cli::finite || t < trace.states.size();
+  // reads a little-endian integer of `bytes` bytes
+  static std::optional<uint64_t> get_uint(std::istream &file, size_t bytes) {
+    unsigned char buf[8];
+    if(!file.read(reinterpret_cast<char *>(buf), std::streamsize(bytes)))
+      return {};
+
+    uint64_t n = 0;
+    for(size_t i = 0; i < bytes; ++i)
+      n |= uint64_t{buf[i]} << (8 * i);
+    return n;
   }
 
-  static
-  bool check(trace_t trace, formula f, size_t t) 
-  {
-    static std::unordered_map<std::tuple<formula, size_t>, bool> memo;
-    if(auto it = memo.find({f, t}); it != memo.end())
-      return it->second;
-
-    bool result = f.match(
-      [](boolean b) {
-        return b.value();
-      },
-      [&](atom a) {
-        return check_atom(trace, a, t);
-      },
-      [&](tomorrow, formula op) {
-        return state_exists(trace, t + 1) && check(trace, op, t + 1);
-      },
-      [&](w_tomorrow, formula op) {
-        return !state_exists(trace, t + 1) || check(trace, op, t + 1);
-      },
-      [&](yesterday, formula op) {
-        return t > 0 && check(trace, op, t - 1);
-      },
-      [&](w_yesterday, formula op) {
-        return t == 0 || check(trace, op, t - 1);
-      },
-      [&](until u) {
-        return check_until(trace, u, t);
-      },
-      [&](since s) {
-        return check_since(trace, s, t);
-      },
-      [&](negation, formula op) {
-        return !check(trace, op, t);
-      },
-      [&](conjunction, formula l, formula r) {
-        return check(trace, l, t) && check(trace, r, t);
-      },
-      [&](disjunction, formula l, formula r) {
-        return check(trace, l, t) || check(trace, r, t);
-      },
-      [&](implication, formula l, formula r) {
-        return !check(trace, l, t) || check(trace, r, t);
-      },
-      [&](iff, formula l, formula r) {
-        return check(trace, l, t) == check(trace, r, t);
-      },
-      [&](eventually, formula op) {
-        return check(trace, U(op.sigma()->top(), op), t);
-      },
-      [&](always, formula op) {
-        return check(trace, !F(!op), t);
-      },
-      [&](w_until, formula l, formula r) {
-        return check(trace, G(l) || U(l, r), t);
-      },
-      [&](release, formula l, formula r) {
-        return check(trace, !U(!l, !r), t);
-      },
-      [&](s_release, formula l, formula r) {
-        return check(trace, !W(!l, !r), t);
-      },
-      [&](once, formula op) {
-        return check(trace, S(op.sigma()->top(), op), t);
-      },
-      [&](historically, formula op) {
-        return check(trace, !O(!op), t);
-      },
-      [&](triggered, formula l, formula r) {
-        return check(trace, !S(!l, !r), t);
-      }
-    );
+  //
+  // Reads a trace in the binary format described in binary_trace.hpp. 
+  // Each state is read as a whole and unpacked directly into the trace.
+  //
+  static 
+  std::optional<trace_file> 
+  parse_binary_trace(std::istream &file, trace_error_handler const&error) {
+    // names longer than this are surely due to a corrupted file
+    constexpr uint64_t max_name_length = 1 << 20;
+
+    auto fail = [&](std::string message) -> std::optional<trace_file> {
+      error(std::move(message));
+      return {};
+    };
+
+    std::string magic(binary_trace_magic.size(), '\0');
+    if(!file.read(magic.data(), std::streamsize(magic.size())) || 
+       magic != binary_trace_magic)
+      return fail("invalid binary trace");
+
+    std::optional<uint64_t> version = get_uint(file, 1);
+    if(version && *version != binary_trace_version)
+      return fail(fmt::format("unsupported binary trace version {}", *version));
+
+    std::optional<uint64_t> result = get_uint(file, 1);
+    std::optional<uint64_t> atoms = get_uint(file, 4);
+    if(!version || !result || !atoms)
+      return fail("truncated binary trace");
+
+    trace_file trace;
+    switch(*result) {
+      case 0: trace.result = "UNKNOWN"; break;
+      case 1: trace.result = "SAT"; break;
+      case 2: trace.result = "UNSAT"; break;
+      default: 
+        return fail("invalid result in binary trace");
+    }
 
-    if(cli::verbose)
-      io::println("{} at t = {} is {}", to_string(f), t, result);
+    std::vector<size_t> indices;
+    for(uint64_t i = 0; i < *atoms; ++i) {
+      std::optional<uint64_t> length = get_uint(file, 4);
+      if(!length)
+        return fail("truncated binary trace");
+      if(*length > max_name_length)
+        return fail("invalid atom name in binary trace");
+
+      std::string name(*length, '\0');
+      if(!file.read(name.data(), std::streamsize(name.size())))
+        return fail("truncated binary trace");
+      indices.push_back(trace.model.intern(name));
+    }
 
-    memo.insert({{f,t}, result});
+    std::optional<uint64_t> size = get_uint(file, 8);
+    std::optional<uint64_t> loop = get_uint(file, 8);
+    if(!size || !loop)
+      return fail("truncated binary trace");
+
+    // same checks as trace_reader::finish(), for models actually given
+    if(*size == 0 && trace.result == "SAT")
+      return fail("empty model");
+
+    if(*size > 0) {
+      if(cli::finite && *loop != binary_trace_no_loop)
+        return fail("expected a finite model, but the trace has a loop");
+      if(!cli::finite && *loop == binary_trace_no_loop)
+        return fail("expected an infinite model, but the trace has no loop");
+      if(!cli::finite && *loop > *size)
+        return fail("loop state greater than model size");
+    }
 
-    return result;
-  }
+    std::string state((*atoms + 3) / 4, '\0');
+    for(uint64_t t = 0; t < *size; ++t) {
+      if(!file.read(state.data(), std::streamsize(state.size())))
+        return fail("truncated binary trace");
+
+      trace.model.push_state();
+      for(size_t i = 0; i < indices.size(); ++i) {
+        unsigned bits = (uint8_t(state[i / 4]) >> (2 * (i % 4))) & 0b11;
+        if(bits == 0b01 || bits == 0b11)
+          trace.model.set(indices[i], t, bits == 0b11);
+        else if(bits != 0b00)
+          return fail("invalid proposition value in binary trace");
+      }
+    }
 
-  static
-  int check(trace_t trace, formula f) {
-    size_t initial_state = 0;
-    if(cli::initial_state)
-      initial_state = *cli::initial_state;
+    if(file.peek() != std::char_traits<char>::eof())
+      return fail("unexpected data at the end of the binary trace");
 
-    bool result = check(trace, f, initial_state);
-    if(result)
-      io::println("TRUE");
-    else {
-      io::println("FALSE");
-      quit(status_code::failed_check);
-    }
-    
-    return 0;
+    trace.model.loop = cli::finite || *size == 0 ? *size : *loop;
+
+    return trace;
   }
 
+  //
+  // Reads a trace file, either in JSON or in binary format, telling them
+  // apart from the first character
+  //
   static 
-  trace_t
-  parse_trace(std::optional<std::string> const&tracepath, std::istream &file) 
-  {
-    std::string path = tracepath ? *tracepath : "<stdin>";
-    json j;
-    try {
-      j = json::parse(file);
-
-      trace_t trace;
-      if(!j["result"].is_null())
-        trace.result = j["result"];
+  std::optional<trace_file> 
+  parse_trace(std::istream &file, trace_error_handler const&error) {
+    if(file.peek() == binary_trace_magic[0])
+      return parse_binary_trace(file, error);
 
-      json model = j["model"];
-      if(model.is_null())
-        return trace;
+    trace_file trace;
+    trace_reader reader{trace};
 
-      if(!cli::finite)
-        trace.loop = model["loop"];
-      else
-        trace.loop = model["size"];
+    if(!json::sax_parse(file, &reader)) {
+      error(reader.error() ? *reader.error() : "invalid trace");
+      return {};
+    }
 
-      if(cli::finite && !model["loop"].is_null())
-        io::fatal(
-          status_code::syntax_error, 
-          "expected a finite model, but a \"loop\" field is present"
-        );
-      
-      if(model["states"].size() == 0)
-        io::fatal(status_code::syntax_error, "{}: empty model", path);
-
-      for(json jstate : model["states"]) {
-        std::map<std::string, black::tribool> state;
-
-        for(auto it = jstate.begin(); it != jstate.end(); ++it) {
-          black::tribool value = black::tribool::undef;
-          if(it.value().get<std::string>() == "undef")
-            value = black::tribool::undef;
-          else if(it.value().get<std::string>() == "true")
-            value = true;
-          else if(it.value().get<std::string>() == "false")
-            value = false;
-          else {
-            io::fatal(
-              status_code::syntax_error, 
-              "{}: invalid proposition value",
-              path
-            );
-          }
-
-          state.insert({it.key(), value});
-        }
-        trace.states.push_back(state);
-      }
+    if(auto message = reader.finish(); message) {
+      error(*message);
+      return {};
+    }
 
-      if(model["size"] != trace.states.size()) {
-        io::fatal(
-          status_code::syntax_error, 
-          "{}: \"size\" field and effective model size disagree",
-          path
-        );
-      }
+    return trace;
+  }
 
-      if(trace.loop > trace.states.size()) {
-        io::fatal(
-          status_code::syntax_error, 
-          "{}: \"loop\" field greater than model size",
-          path
-        );
-      }
+  //
+  // Checks the trace against all the given formulas at once, so that the 
+  // subformulas they have in common are evaluated only once, and gives a 
+  // verdict for each formula
+  //
+  static
+  std::vector<verdict> check(
+    std::vector<formula> const&fs, trace_file const&trace, 
+    black::trace_checker::tracer_t tracer = {}
+  ) {
+    auto all = [&](verdict v) { return std::vector<verdict>(fs.size(), v); };
 
-      return trace;
+    if(cli::expected_result && trace.result != *cli::expected_result)
+      return all({"MISMATCH", status_code::failed_check});
 
-    } catch (json::exception& ex) {
-      io::fatal(status_code::syntax_error, "{}:{}", path, ex.what());
+    if(
+      (!trace.result || trace.result != "SAT") && trace.model.size() == 0
+    ) {
+      return all({"MATCH"});
     }
+
+    size_t initial_state = 0;
+    if(cli::initial_state)
+      initial_state = *cli::initial_state;
+
+    if(cli::finite && initial_state >= trace.model.size())
+      return all({
+        fmt::format(
+          "initial state {} is past the end of the trace", initial_state
+        ), 
+        status_code::command_line_error, true
+      });
+
+    black::trace_checker checker{trace.model, cli::finite};
+    checker.set_tracer(std::move(tracer));
+
+    std::vector<verdict> verdicts;
+    for(bool value : checker.check(fs, initial_state))
+      verdicts.push_back(
+        value ? verdict{"TRUE"} : verdict{"FALSE", status_code::failed_check}
+      );
+    
+    return verdicts;
   }
 
+  //
+  // Checks a single trace. When more formulas are given, each verdict is 
+  // prefixed by the corresponding formula as written on the command line.
+  //
   static
   int trace_check(
-    std::optional<std::string> const&path,
-    std::istream &file,
+    std::vector<formula> const&fs,
     std::optional<std::string> const&tracepath,
     std::istream &tracefile
   ) {
-    black::alphabet sigma;
+    std::string tpath = tracepath ? *tracepath : "<stdin>";
+    std::optional<trace_file> trace = 
+      parse_trace(tracefile, [&](std::string error) {
+        io::fatal(status_code::syntax_error, "{}: {}", tpath, error);
+      });
+    black_assert(trace.has_value());
+
+    black::trace_checker::tracer_t tracer;
+    if(cli::verbose)
+      tracer = [](formula sub, size_t t, bool value) {
+        io::println("{} at t = {} is {}", to_string(sub), t, value);
+      };
+
+    std::vector<verdict> verdicts = check(fs, *trace, std::move(tracer));
+    if(verdicts[0].error)
+      io::fatal(verdicts[0].status, "{}", verdicts[0].message);
+
+    status_code status = status_code::success;
+    for(size_t i = 0; i < fs.size(); ++i) {
+      if(fs.size() == 1)
+        io::println("{}", verdicts[i].message);
+      else
+        io::println("{}: {}", cli::formulas[i], verdicts[i].message);
+      
+      if(verdicts[i].status != status_code::success)
+        status = verdicts[i].status;
+    }
 
-    black::formula f = 
-      *black::parse_formula(sigma, file, formula_syntax_error_handler(path));
+    quit(status);
+  }
 
-    trace_t trace = parse_trace(tracepath, tracefile);
+  //
+  // The traces to check in batch mode: either all the regular files in a
+  // directory, in lexicographic order, or a list of paths, one per line, 
+  // read from a file or from stdin.
+  //
+  static std::vector<std::string> batch_traces(std::string const&batch) {
+    namespace fs = std::filesystem;
+    
+    std::vector<std::string> paths;
+    std::error_code ec;
+    if(batch != "-" && fs::is_directory(batch, ec)) {
+      for(auto const&entry : fs::directory_iterator{batch, ec})
+        if(entry.is_regular_file())
+          paths.push_back(entry.path().string());
+      
+      if(ec)
+        io::fatal(status_code::filesystem_error,
+          "Unable to read directory `{}`: {}", batch, ec.message()
+        );
 
-    if(cli::expected_result) {
-      if(trace.result != *cli::expected_result) {
-        io::println("MISMATCH");
-        quit(status_code::failed_check);
-      }
+      std::sort(paths.begin(), paths.end());
+      return paths;
     }
 
-    if((!trace.result || trace.result != "SAT") && trace.states.size() == 0) {
-      io::println("MATCH");
-      quit(status_code::success);
+    auto read = [&](std::istream &list) {
+      std::string line;
+      while(std::getline(list, line))
+        if(!line.empty())
+          paths.push_back(line);
+    };
+
+    if(batch == "-") {
+      read(std::cin);
+    } else {
+      std::ifstream list = open_file(batch);
+      read(list);
+    }
+
+    return paths;
+  }
+
+  static verdict check_trace_file(formula f, std::string const&path) {
+    std::ifstream file{path, std::ios::in};
+    if(!file)
+      return {
+        fmt::format("unable to open file: {}", system_error_string(errno)),
+        status_code::filesystem_error, true
+      };
+
+    std::optional<verdict> error;
+    std::optional<trace_file> trace = 
+      parse_trace(file, [&](std::string message) {
+        error = verdict{std::move(message), status_code::syntax_error, true};
+      });
+    
+    if(!trace)
+      return *error;
+
+    return check({f}, *trace)[0];
+  }
+
+  //
+  // Checks all the traces in batch mode against the same formula, in 
+  // parallel over a pool of `cli::jobs` threads. Checking does not create 
+  // new formulas, so the threads can share the formula and its alphabet.
+  //
+  static int batch_check(formula f) {
+    std::vector<std::string> paths = batch_traces(*cli::batch);
+    std::vector<verdict> verdicts(paths.size());
+
+    size_t jobs = cli::jobs ? *cli::jobs : std::thread::hardware_concurrency();
+    jobs = std::clamp<size_t>(jobs, 1, std::max<size_t>(paths.size(), 1));
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> next = 0;
+    auto worker = [&]() {
+      for(size_t i = next++; i < paths.size(); i = next++)
+        verdicts[i] = check_trace_file(f, paths[i]);
+    };
+
+    std::vector<std::thread> pool;
+    for(size_t i = 1; i < jobs; ++i)
+      pool.emplace_back(worker);
+    worker();
+    for(std::thread &t : pool)
+      t.join();
+
+    std::chrono::duration<double> elapsed = 
+      std::chrono::steady_clock::now() - start;
+
+    size_t passed = 0, failed = 0, errors = 0;
+    status_code status = status_code::success;
+    for(size_t i = 0; i < paths.size(); ++i) {
+      verdict const&v = verdicts[i];
+      if(v.error)
+        io::println("{}: ERROR: {}", paths[i], v.message);
+      else
+        io::println("{}: {}", paths[i], v.message);
+
+      // the first error takes precedence over failed checks
+      if(v.error) {
+        if(errors++ == 0)
+          status = v.status;
+      } else if(v.status == status_code::success)
+        passed++;
+      else if(failed++ == 0 && errors == 0)
+        status = v.status;
     }
 
-    return check(trace, f);
+    io::println(
+      "{} passed, {} failed, {} errors ({} traces in {:.3f}s, {} jobs)",
+      passed, failed, errors, paths.size(), elapsed.count(), jobs
+    );
+
+    quit(status);
   }
 
   int trace_check() {
-    if(!cli::filename && !cli::formula) {
+    if(!cli::filename && cli::formulas.empty()) {
       command_line_error("please specify a filename or the --formula option");
       quit(status_code::command_line_error);
     }
 
-    if(cli::filename && cli::formula) {
+    if(cli::filename && !cli::formulas.empty()) {
       command_line_error(
         "please specify only either a filename or the --formula option"
       );
       quit(status_code::command_line_error);
     }
 
-    if(*cli::filename == "-" && cli::trace == "-") {
+    if(cli::batch) {
+      if(cli::verbose) {
+        command_line_error("--verbose is not supported together with --batch");
+        quit(status_code::command_line_error);
+      }
+
+      if(cli::formulas.size() > 1) {
+        command_line_error("only one formula can be checked with --batch");
+        quit(status_code::command_line_error);
+      }
+
+      if(cli::filename == "-" && cli::batch == "-") {
+        command_line_error(
+          "cannot read from stdin both the formula file and the trace list"
+        );
+        quit(status_code::command_line_error);
+      }
+    } else if(cli::filename == "-" && cli::trace == "-") {
       command_line_error(
         "cannot read from stdin both the formula file and the trace file"
       );
       quit(status_code::command_line_error);
     }
 
-    if(cli::formula) {
-      std::istringstream str{*cli::formula};
-
-      if(cli::trace == "-")
-        return trace_check(std::nullopt, str, std::nullopt, std::cin);
-
-      std::ifstream tracefile = open_file(cli::trace);
-      return trace_check(std::nullopt, str, cli::trace, tracefile);
+    // all the formulas share the same alphabet, so that their common 
+    // subformulas are the same objects and are labelled only once
+    black::alphabet sigma;
+    std::vector<formula> fs;
+    
+    if(cli::filename == "-")
+      fs.push_back(*black::parse_formula(
+        sigma, std::cin, formula_syntax_error_handler(std::nullopt)
+      ));
+    else if(cli::filename) {
+      std::ifstream file = open_file(*cli::filename);
+      fs.push_back(*black::parse_formula(
+        sigma, file, formula_syntax_error_handler(cli::filename)
+      ));
     }
 
-    if(*cli::filename == "-") {
-      std::ifstream tracefile = open_file(cli::trace);
-      return trace_check(std::nullopt, std::cin, cli::trace, tracefile);
-    }
+    for(std::string const&s : cli::formulas)
+      fs.push_back(*black::parse_formula(
+        sigma, s, formula_syntax_error_handler(std::nullopt)
+      ));
 
-    if(cli::trace == "-") {
-      std::ifstream file = open_file(*cli::filename);
-      return trace_check(cli::filename, file, std::nullopt, std::cin);
-    }
+    if(cli::batch)
+      return batch_check(fs[0]);
+
+    if(cli::trace == "-")
+      return trace_check(fs, std::nullopt, std::cin);
 
-    std::ifstream file = open_file(*cli::filename);
     std::ifstream tracefile = open_file(cli::trace);
-    return trace_check(cli::filename, file, cli::trace, tracefile);
+    return trace_check(fs, cli::trace, tracefile);
   }
 }
@@ -30,54 +30,200 @@
 
 #include <vector>
 #include <initializer_list>
+#include <iterator>
 #include <memory>
 
 namespace black::internal
 {
 
-  // TODO: Compress the boolean into the pointer to the atom
-  struct literal {
-    bool sign;
-    struct atom atom;
+  //
+  // A literal packed in a single word: the unique id of the atom, with the
+  // sign in the least significant bit, which is always zero in the id.
+  //
+  class literal 
+  {
+  public:
+    literal() = default;
+    literal(bool sign, atom a) 
+      : _bits{static_cast<uintptr_t>(a.unique_id()) | !sign} 
+    { 
+      black_assert((static_cast<uintptr_t>(a.unique_id()) & 1) == 0);
+    }
+
+    // true = positive, false = negative
+    bool sign() const { return (_bits & 1) == 0; }
+
+    formula_id atom_id() const { return static_cast<formula_id>(_bits & ~1); }
+
+    class atom atom(alphabet &sigma) const { 
+      return *sigma.from_id(atom_id()).to<class atom>(); 
+    }
+
+    friend literal operator!(literal l) {
+      literal r;
+      r._bits = l._bits ^ 1;
+      return r;
+    }
+
+    friend bool operator==(literal l1, literal l2) { 
+      return l1._bits == l2._bits; 
+    }
+    
+    friend bool operator!=(literal l1, literal l2) { 
+      return l1._bits != l2._bits; 
+    }
+
+  private:
+    uintptr_t _bits = 0;
   };
 
-  struct clause {
-    std::vector<literal> literals;
-
-    clause() = default;
-    clause(std::vector<literal> lits) : literals(std::move(lits)) { }
-    clause(std::initializer_list<literal> elems) : literals{elems} { }
+  //
+  // A clause of a cnf, as a view over its literals
+  //
+  class clause 
+  {
+  public:
+    clause(literal const *begin, literal const *end) 
+      : _begin{begin}, _end{end} { }
+
+    literal const *begin() const { return _begin; }
+    literal const *end() const { return _end; }
+    size_t size() const { return static_cast<size_t>(_end - _begin); }
+    bool empty() const { return _begin == _end; }
+    literal operator[](size_t i) const { return _begin[i]; }
+
+  private:
+    literal const *_begin;
+    literal const *_end;
   };
 
-  struct cnf
+  //
+  // A formula in CNF, stored flat: the literals of all the clauses are 
+  // contiguous, and each clause is identified by the offset of its end.
+  //
+  class cnf
   {
-    std::vector<clause> clauses;
+  public:
+    class iterator;
 
     cnf() = default;
-    cnf(std::vector<clause> _clauses) : clauses(std::move(_clauses)) { }
-    cnf(std::initializer_list<clause> elems) : clauses{elems} { }
+    cnf(std::initializer_list<std::initializer_list<literal>> clauses) {
+      for(auto c : clauses)
+        add_clause(c);
+    }
+
+    // number of clauses
+    size_t size() const { return _ends.size(); }
+    bool empty() const { return _ends.empty(); }
+
+    clause operator[](size_t i) const { 
+      literal const *base = _literals.data();
+      return {base + (i == 0 ? 0 : _ends[i - 1]), base + _ends[i]};
+    }
+
+    iterator begin() const;
+    iterator end() const;
+
+    // the literals of all the clauses, in order
+    std::vector<literal> const& literals() const { return _literals; }
+
+    // adds a clause to the cnf
+    void add_clause(std::initializer_list<literal> lits) {
+      _literals.insert(_literals.end(), lits);
+      end_clause();
+    }
+
+    // builds a clause literal by literal
+    void push_literal(literal l) { _literals.push_back(l); }
+    void end_clause() { _ends.push_back(_literals.size()); }
+
+    void clear() {
+      _literals.clear();
+      _ends.clear();
+    }
+
+  private:
+    std::vector<literal> _literals;
+    std::vector<size_t> _ends;
+  };
 
+  class cnf::iterator 
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = clause;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = clause;
+
+    iterator(cnf const &c, size_t i) : _cnf{&c}, _i{i} { }
+
+    clause operator*() const { return (*_cnf)[_i]; }
+
+    iterator &operator++() {
+      ++_i;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator it = *this;
+      ++_i;
+      return it;
+    }
+
+    friend bool operator==(iterator it1, iterator it2) { 
+      return it1._i == it2._i; 
+    }
+
+    friend bool operator!=(iterator it1, iterator it2) { 
+      return it1._i != it2._i; 
+    }
+
+  private:
+    cnf const *_cnf;
+    size_t _i;
   };
 
-  // Tseitin conversion to CNF
+  inline cnf::iterator cnf::begin() const { return {*this, 0}; }
+  inline cnf::iterator cnf::end() const { return {*this, size()}; }
+
+  // Kind of definitions used in the conversion to CNF:
+  // - tseitin: both directions of each definition are emitted
+  // - plaisted_greenbaum: only the directions required by the polarity of 
+  //   the subformula are emitted. The result is equisatisfiable, but the 
+  //   value of the fresh variables in a model may differ from the value of 
+  //   the subformulas they stand for.
+  enum class cnf_encoding : uint8_t {
+    tseitin,
+    plaisted_greenbaum
+  };
+
+  // Conversion to CNF
+  BLACK_EXPORT
+  cnf to_cnf(formula f, cnf_encoding encoding = cnf_encoding::tseitin);
+
+  // Same as above, but appends the clauses to an existing cnf, whose
+  // storage can thus be reused across calls
   BLACK_EXPORT
-  cnf to_cnf(formula f);
+  void to_cnf(formula f, cnf &result, 
+              cnf_encoding encoding = cnf_encoding::tseitin);
 
   // Conversion of literals, clauses and cnfs to formulas
   BLACK_EXPORT
-  formula to_formula(literal lit);
+  formula to_formula(alphabet &sigma, literal lit);
 
   BLACK_EXPORT
   formula to_formula(alphabet &sigma, clause c);
 
   BLACK_EXPORT
-  formula to_formula(alphabet &sigma, cnf c);
+  formula to_formula(alphabet &sigma, cnf const& c);
 }
 
 namespace black {
   using internal::literal;
   using internal::clause;
   using internal::cnf;
+  using internal::cnf_encoding;
   using internal::to_cnf;
   using internal::to_formula;
 }
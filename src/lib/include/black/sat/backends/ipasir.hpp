@@ -0,0 +1,73 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef BLACK_SAT_BACKENDS_IPASIR_HPP
+#define BLACK_SAT_BACKENDS_IPASIR_HPP
+
+#include <black/support/common.hpp>
+#include <black/sat/solver.hpp>
+#include <black/sat/dimacs.hpp>
+
+#include <memory>
+#include <string>
+#include <optional>
+
+namespace black::sat::backends 
+{
+  //
+  // Backend for any incremental SAT solver implementing the IPASIR interface,
+  // loaded at runtime from a shared library.
+  //
+  class BLACK_EXPORT ipasir : public ::black::sat::dimacs::solver
+  {
+  public:
+    // loads the solver from the shared library at the given path, 
+    // which must have already been validated, e.g. by register_backend()
+    ipasir(std::string const& library);
+    virtual ~ipasir() override;
+
+    // Loads the shared library at the given path and registers it as a SAT
+    // backend under the given name. Returns an error message on failure.
+    static std::optional<std::string> 
+    register_backend(std::string name, std::string const& library);
+
+    // the signature string reported by the solver (name and version)
+    std::string signature() const;
+
+    virtual void new_vars(size_t n) override;
+    virtual size_t nvars() const override;
+    virtual void assert_clause(dimacs::clause const& f) override;
+    virtual bool is_sat() override;
+    virtual 
+    bool is_sat_with(std::vector<dimacs::literal> const& assumptions) override;
+    virtual tribool value(uint32_t v) const override;
+    virtual void clear() override;
+    virtual std::optional<std::string> license() const override;
+
+  private:
+    struct _ipasir_t;
+    std::unique_ptr<_ipasir_t> _data;
+  };
+}
+
+#endif // BLACK_SAT_BACKENDS_IPASIR_HPP
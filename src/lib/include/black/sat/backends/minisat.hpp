@@ -35,11 +35,15 @@ namespace black::sat::backends
 
     virtual void new_vars(size_t n) override;
     virtual size_t nvars() const override;
-    virtual void assert_clause(dimacs::clause f) override;
+    virtual void assert_clause(dimacs::clause const& f) override;
     virtual bool is_sat() override;
     virtual 
     bool is_sat_with(std::vector<dimacs::literal> const& assumptions) override;
     virtual tribool value(uint32_t v) const override;
+    virtual 
+    bool set_option(std::string_view name, option_value const& v) override;
+    virtual void enable_elimination() override;
+    virtual void freeze(uint32_t v) override;
     virtual void clear() override;
     virtual std::optional<std::string> license() const override;
 
@@ -0,0 +1,86 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef BLACK_SAT_BACKENDS_RECORDER_HPP
+#define BLACK_SAT_BACKENDS_RECORDER_HPP
+
+#include <black/support/common.hpp>
+#include <black/sat/solver.hpp>
+#include <black/sat/dimacs.hpp>
+
+#include <memory>
+#include <string>
+#include <optional>
+
+namespace black::sat::backends
+{
+  //
+  // Wrapper around another backend that records the clauses, the
+  // assumptions and the solve calls it receives, as an incremental CNF
+  // (iCNF) file that can be later replayed with dimacs::replay().
+  //
+  // Each session, i.e. each instance or each call to clear(), is recorded
+  // in its own file: the first one at the given path, and the following
+  // ones at `path.1`, `path.2`, etc.
+  //
+  class BLACK_EXPORT recorder : public ::black::sat::dimacs::solver
+  {
+  public:
+    // records the calls to a new instance of the given backend,
+    // which must exist, into the file at the given path
+    recorder(std::string const& backend, std::string path);
+    virtual ~recorder() override;
+
+    // Registers a backend with the given name that records the calls to
+    // `backend` into the given file. Returns an error message on failure.
+    static std::optional<std::string> register_backend(
+      std::string name, std::string backend, std::string path
+    );
+
+    // The first error raised while recording the sessions at the given 
+    // path, e.g. a file that could not be opened or written. Recording 
+    // stops at the failing session, but the solver keeps working, so
+    // callers must check this to know whether the recording is complete.
+    static std::optional<std::string> error(std::string const& path);
+
+    virtual void new_vars(size_t n) override;
+    virtual size_t nvars() const override;
+    virtual void assert_clause(dimacs::clause const& f) override;
+    virtual bool is_sat() override;
+    virtual
+    bool is_sat_with(std::vector<dimacs::literal> const& assumptions) override;
+    virtual tribool value(uint32_t v) const override;
+    virtual 
+    bool set_option(std::string_view name, option_value const& v) override;
+    virtual void enable_elimination() override;
+    virtual void freeze(uint32_t v) override;
+    virtual void clear() override;
+    virtual std::optional<std::string> license() const override;
+
+  private:
+    struct _recorder_t;
+    std::unique_ptr<_recorder_t> _data;
+  };
+}
+
+#endif // BLACK_SAT_BACKENDS_RECORDER_HPP
@@ -38,6 +38,8 @@ namespace black::sat::backends
     virtual bool is_sat() override;
     virtual bool is_sat_with(formula assumption) override;
     virtual tribool value(atom a) const override;
+    virtual 
+    bool set_option(std::string_view name, option_value const& v) override;
     virtual void clear() override;
     virtual std::optional<std::string> license() const override;
 
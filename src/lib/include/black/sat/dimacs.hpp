@@ -45,8 +45,53 @@ namespace black::sat::dimacs::internal
     std::vector<literal> literals;
   };
 
+  //
+  // A clause of a problem, as a view over its literals
+  //
+  class clause_view {
+  public:
+    clause_view(literal const *begin, literal const *end) 
+      : _begin{begin}, _end{end} { }
+
+    literal const *begin() const { return _begin; }
+    literal const *end() const { return _end; }
+    size_t size() const { return static_cast<size_t>(_end - _begin); }
+    literal operator[](size_t i) const { return _begin[i]; }
+
+  private:
+    literal const *_begin;
+    literal const *_end;
+  };
+
+  //
+  // A solve call of an incremental problem, made after asserting the first 
+  // `nclauses' clauses, under the given assumptions
+  //
+  struct query {
+    size_t nclauses;
+    std::vector<literal> assumptions;
+  };
+
+  //
+  // A DIMACS problem, stored flat: the literals of all the clauses are
+  // contiguous, and each clause is identified by the offset of its end.
+  // Incremental problems (in iCNF format) also carry their solve calls.
+  //
   struct problem {
-    std::vector<clause> clauses;
+    std::vector<literal> literals;
+    std::vector<size_t> ends;
+    uint32_t nvars = 0; // the greatest variable occurring in the problem
+    
+    bool incremental = false;
+    std::vector<query> queries;
+
+    // number of clauses
+    size_t size() const { return ends.size(); }
+
+    clause_view operator[](size_t i) const {
+      literal const *base = literals.data();
+      return {base + (i == 0 ? 0 : ends[i - 1]), base + ends[i]};
+    }
   };
 
   BLACK_EXPORT
@@ -54,11 +99,25 @@ namespace black::sat::dimacs::internal
     std::istream &in, std::function<void(std::string)> error_handler
   );
 
+  // parses the problem from the given buffer
+  BLACK_EXPORT
+  std::optional<problem> parse(
+    char const *begin, char const *end, 
+    std::function<void(std::string)> error_handler
+  );
+
+  // parses the problem from the given file, memory-mapped if supported
+  BLACK_EXPORT
+  std::optional<problem> parse_file(
+    std::string const& path, std::function<void(std::string)> error_handler
+  );
+
   BLACK_EXPORT
   std::string to_string(literal l);
 
+  // prints the problem in DIMACS format, or iCNF if incremental
   BLACK_EXPORT
-  void print(std::ostream &out, problem p);
+  void print(std::ostream &out, problem const& p);
 
   struct solution {
     std::vector<literal> assignments;
@@ -71,7 +130,16 @@ namespace black::sat::dimacs::internal
   formula to_formula(alphabet &sigma, problem const& p);
 
   BLACK_EXPORT
-  std::optional<solution> solve(problem const& p, std::string backend);
+  std::optional<solution> solve(
+    problem const& p, std::string backend, sat::options const& opts = {}
+  );
+
+  // replays the solve calls of an incremental problem on the given backend,
+  // returning their results
+  BLACK_EXPORT
+  std::vector<bool> replay(
+    problem const& p, std::string backend, sat::options const& opts = {}
+  );
 
   BLACK_EXPORT
   void print(std::ostream &out, std::optional<solution> const& s);
@@ -91,6 +159,10 @@ namespace black::sat::dimacs::internal
     virtual void assert_formula(formula f) override;
     virtual bool is_sat_with(formula assumption) override;
     virtual tribool value(atom a) const override;
+
+    // kind of CNF conversion used by assert_formula() and is_sat_with()
+    void set_cnf_encoding(cnf_encoding encoding);
+    cnf_encoding get_cnf_encoding() const;
     
     // specialized DIMACS interface
 
@@ -101,7 +173,7 @@ namespace black::sat::dimacs::internal
     virtual size_t nvars() const = 0;
 
     // assert a new clause
-    virtual void assert_clause(clause c) = 0;
+    virtual void assert_clause(clause const& c) = 0;
 
     // solve the instance
     virtual bool is_sat() override = 0;
@@ -112,6 +184,16 @@ namespace black::sat::dimacs::internal
     // retrieve the value of an atom after is_sat() or is_sat_with() 
     virtual tribool value(uint32_t var) const = 0;
 
+    // Enables the elimination of variables in the preprocessing done by 
+    // the backend, if supported. Once enabled, variables used in clauses or
+    // assumptions after a call to is_sat() or is_sat_with() must have been
+    // frozen before it. The values of eliminated variables are still 
+    // available after a satisfiable call.
+    virtual void enable_elimination();
+
+    // protects the given variable from elimination
+    virtual void freeze(uint32_t var);
+
     // clears the state of the solver
     virtual void clear() override = 0;
 
@@ -131,12 +213,16 @@ namespace black::sat::dimacs::internal
 namespace black::sat::dimacs {
   using internal::literal;
   using internal::clause;
+  using internal::clause_view;
+  using internal::query;
   using internal::problem;
   using internal::solution;
   using internal::parse;
+  using internal::parse_file;
   using internal::to_string;
   using internal::print;
   using internal::solve;
+  using internal::replay;
   using internal::solver;
 }
 
@@ -31,10 +31,26 @@
 #include <memory>
 #include <type_traits>
 #include <string_view>
+#include <string>
 #include <vector>
+#include <optional>
+#include <functional>
+#include <map>
+#include <variant>
+#include <cstdint>
 
 namespace black::sat 
 {  
+  //
+  // Tuning options for the backends, as typed key/value pairs. Each backend 
+  // honours the options that apply to it:
+  // - `threads` (integer): number of solving threads (cmsat, z3)
+  // - `seed` (integer): seed for randomized heuristics (minisat, z3)
+  // - `memory` (integer): memory limit in megabytes (z3)
+  //
+  using option_value = std::variant<bool, int64_t, std::string>;
+  using options = std::map<std::string, option_value, std::less<>>;
+
 
   //
   // Generic interface to backend SAT solvers
@@ -45,10 +61,25 @@ namespace black::sat
     // default constructor
     solver() = default;
 
+    // Backends provided by modules are loaded on demand. backend_exists() 
+    // returns false and get_solver() returns nullptr if the module of the 
+    // backend cannot be loaded, and backend_error() tells why. backends() 
+    // does not list the modules that already failed to load.
     static std::vector<std::string_view> backends();
     static bool backend_exists(std::string_view name);
+    static std::optional<std::string> backend_error(std::string_view name);
     static std::unique_ptr<solver> get_solver(std::string_view name);
 
+    // Creates a solver with the given options set. Options that do not apply
+    // to the backend are ignored.
+    static std::unique_ptr<solver> 
+    get_solver(std::string_view name, options const& opts);
+
+    // Registers a backend at runtime, under the given name, which must not 
+    // be already taken. Returns false otherwise.
+    using backend_ctor = std::function<std::unique_ptr<solver>()>;
+    static bool register_backend(std::string name, backend_ctor ctor);
+
     // solver is a polymorphic, non-copyable type
     solver(const solver &) = delete;
     solver &operator=(const solver &) = delete;
@@ -70,6 +101,12 @@ namespace black::sat
     // e.g. before the first call to is_sat()
     virtual tribool value(atom a) const = 0;
 
+    // Sets a tuning option, before asserting anything. Returns false if 
+    // the option does not apply to the backend, if the value has the 
+    // wrong type or is out of range, or if the option cannot be changed 
+    // anymore because something has already been asserted.
+    virtual bool set_option(std::string_view name, option_value const& value);
+
     // clear the current context completely
     virtual void clear() = 0;
 
@@ -27,7 +27,9 @@
 #include <black/support/common.hpp>
 #include <black/logic/formula.hpp>
 #include <black/logic/alphabet.hpp>
+#include <black/logic/cnf.hpp>
 #include <black/support/tribool.hpp>
+#include <black/sat/solver.hpp>
 
 #include <vector>
 #include <utility>
@@ -70,6 +72,18 @@ namespace black::internal {
       // Retrieve the current SAT backend
       std::string sat_backend() const;
 
+      // Sets a tuning option of the SAT backend (see black::sat::options), 
+      // used from the next call to solve()
+      void set_sat_option(std::string name, sat::option_value value);
+
+      // Choose the kind of CNF definitions used with DIMACS-based backends,
+      // from the next call to solve(). Other backends receive formulas and 
+      // are not affected. Default: cnf_encoding::tseitin
+      void set_cnf_encoding(cnf_encoding encoding);
+
+      // Retrieve the current kind of CNF definitions
+      cnf_encoding get_cnf_encoding() const;
+
     private:
       struct _solver_t;
       std::unique_ptr<_solver_t> _data;
@@ -79,9 +93,28 @@ namespace black::internal {
   class BLACK_EXPORT model
   {
     public:
+      // values of some atoms at all the states of a model, stored densely
+      struct matrix {
+        size_t size = 0;
+        size_t loop = 0;
+        std::vector<atom> atoms;
+
+        // values[i * size + t] is the value of atoms[i] at state t
+        std::vector<tribool> values;
+
+        tribool value(size_t i, size_t t) const { 
+          return values[i * size + t]; 
+        }
+      };
+
       size_t size() const;
       size_t loop() const;
       tribool value(atom a, size_t t) const;
+
+      // Values of the given atoms at all the states, and the loop index, 
+      // read from the SAT backend in one pass. Prefer this to loop() and 
+      // value() when the whole model is needed, e.g. to print it.
+      matrix extract(std::vector<atom> atoms) const;
     private:
       friend class solver;
       model(solver const&s) : _solver{s} { }
@@ -94,6 +127,7 @@ namespace black::internal {
 // Names exported to the user
 namespace black {
   using internal::solver;
+  using internal::model;
 }
 
 #endif // SOLVER_HPP
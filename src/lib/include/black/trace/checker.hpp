@@ -0,0 +1,77 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef BLACK_TRACE_CHECKER_HPP
+#define BLACK_TRACE_CHECKER_HPP
+
+#include <black/support/common.hpp>
+#include <black/logic/formula.hpp>
+#include <black/trace/trace.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace black::internal
+{
+  //
+  // Checks formulas against a given trace. Each instance holds the state
+  // relative to a single trace, and the labels computed for the checked 
+  // subformulas are kept across calls to check(). Different instances can be
+  // used concurrently from different threads on formulas from the same 
+  // alphabet, since checking does not create new formulas.
+  //
+  class BLACK_EXPORT trace_checker 
+  {
+  public:
+    // If `finite` is true, formulas are interpreted over the finite trace,
+    // otherwise the trace is the prefix and loop of an infinite one.
+    // The trace must outlive the checker.
+    trace_checker(trace const&t, bool finite);
+    ~trace_checker();
+
+    // called with the value of each subformula at each position, as soon as
+    // the subformula has been evaluated
+    using tracer_t = std::function<void(formula, size_t, bool)>;
+    void set_tracer(tracer_t tracer);
+
+    // value of `f` at position `t` of the trace. On finite traces, `t` must
+    // be less than the size of the trace.
+    bool check(formula f, size_t t = 0);
+
+    // values of all the given formulas at position `t`, labelling only 
+    // once the subformulas they have in common
+    std::vector<bool> check(std::vector<formula> const&fs, size_t t = 0);
+
+  private:
+    struct _checker_t;
+    std::unique_ptr<_checker_t> _data;
+  };
+}
+
+namespace black {
+  using internal::trace_checker;
+}
+
+#endif // BLACK_TRACE_CHECKER_HPP
@@ -0,0 +1,93 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef BLACK_TRACE_MONITOR_HPP
+#define BLACK_TRACE_MONITOR_HPP
+
+#include <black/support/common.hpp>
+#include <black/support/tribool.hpp>
+#include <black/logic/formula.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace black::internal
+{
+  //
+  // Online monitor for formulas with past operators and bounded future 
+  // operators (X and wX), interpreted over the finite trace made of the 
+  // states fed so far. States are fed one at a time, and the verdict for 
+  // each position is given as soon as it is determined, i.e. after 
+  // `delay()` more states have been fed, or when the trace ends.
+  //
+  // Each state costs O(|f|) time, and memory is O(|f| * delay()), which is
+  // constant for pure past formulas.
+  //
+  class BLACK_EXPORT monitor 
+  {
+  public:
+    // The formula must be monitorable (see monitorable() below)
+    explicit monitor(formula f);
+    ~monitor();
+
+    monitor(monitor &&);
+    monitor &operator=(monitor &&);
+
+    // Returns an error message if the formula cannot be monitored, i.e. if
+    // it contains unbounded future operators
+    static std::optional<std::string> monitorable(formula f);
+
+    // atoms of the formula, in the order in which their values are given 
+    // to step()
+    std::vector<atom> const&atoms() const;
+
+    // number of states needed after a position to determine its verdict,
+    // i.e. the maximum nesting of X and wX operators
+    size_t delay() const;
+
+    // Feeds the next state, giving the values of atoms() in order. 
+    // Undefined values are don't cares and are taken as true.
+    // Returns the verdict for position `size() - delay() - 1`, if any.
+    std::optional<bool> step(std::vector<tribool> const&state);
+
+    // number of states fed so far
+    size_t size() const;
+
+    // Ends the trace, returning the verdicts for the last positions that 
+    // were still pending. No more states can be fed afterwards.
+    std::vector<bool> finish();
+
+  private:
+    struct _monitor_t;
+    std::unique_ptr<_monitor_t> _data;
+  };
+}
+
+namespace black {
+  using internal::monitor;
+}
+
+#endif // BLACK_TRACE_MONITOR_HPP
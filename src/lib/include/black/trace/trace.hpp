@@ -0,0 +1,96 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef BLACK_TRACE_TRACE_HPP
+#define BLACK_TRACE_TRACE_HPP
+
+#include <black/support/common.hpp>
+#include <black/support/tribool.hpp>
+
+#include <string>
+#include <optional>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+namespace black::internal
+{
+  //
+  // Compact representation of a trace, i.e. a (possibly looping) sequence of
+  // states assigning truth values to propositions. Proposition names are 
+  // interned into consecutive indices, and the values of each proposition 
+  // along the whole trace are stored as a pair of bitsets, telling whether 
+  // the value is known in each state and, if so, which one it is. 
+  // Propositions not mentioned in a state are undefined there.
+  //
+  class BLACK_EXPORT trace 
+  {
+  public:
+    // index of the state the last one loops back to. On finite traces, or
+    // infinite ones without a loop, it is equal to size()
+    size_t loop = 0;
+
+    // number of states
+    size_t size() const { return _size; }
+
+    // number of distinct propositions
+    size_t propositions() const { return _columns.size(); }
+
+    // index of the given proposition, if it appears in the trace
+    std::optional<size_t> index(std::string const& name) const;
+
+    // index of the given proposition, which is added if not present
+    size_t intern(std::string const& name);
+
+    // appends a new state where all the propositions are undefined
+    size_t push_state() { return _size++; }
+
+    // value of proposition `p` at state `t`
+    tribool value(size_t p, size_t t) const;
+
+    // values of proposition `p` in the states [64w, 64w + 64), as a pair of
+    // masks telling which values are known and what they are
+    std::pair<uint64_t, uint64_t> word(size_t p, size_t w) const;
+
+    // sets the value of proposition `p` at state `t`
+    void set(size_t p, size_t t, tribool v);
+
+  private:
+    struct column_t {
+      std::vector<uint64_t> known;
+      std::vector<uint64_t> value;
+    };
+
+    size_t _size = 0;
+    std::unordered_map<std::string, size_t> _indices;
+    std::vector<column_t> _columns;
+  };
+}
+
+namespace black {
+  using internal::trace;
+}
+
+#endif // BLACK_TRACE_TRACE_HPP
@@ -0,0 +1,252 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef BLACK_SOLVER_CLAUSAL_HPP
+#define BLACK_SOLVER_CLAUSAL_HPP
+
+#include <black/logic/formula.hpp>
+#include <black/logic/cnf.hpp>
+#include <black/sat/dimacs.hpp>
+#include <black/solver/encoding.hpp>
+
+#include <vector>
+#include <array>
+#include <optional>
+
+#include <tsl/hopscotch_map.h>
+
+namespace black::internal {
+
+  //
+  // Clause-level counterpart of `encoder`, used with DIMACS-based backends.
+  //
+  // The closure of the formula is indexed once at construction. Each step k
+  // of the unraveling gets a contiguous block of variables, one for each
+  // element of the closure that needs one. The clauses of the encoding are
+  // precomputed as templates over offsets in these blocks, and each step is
+  // emitted to the backend by shifting the templates to the right blocks,
+  // without building or hashing any formula.
+  //
+  // With cnf_encoding::plaisted_greenbaum, the definitions of the non-ground
+  // elements only get the directions required by the polarity with which
+  // they occur. The value of the formula, of the requests and of their 
+  // operands and eventualities are used in both directions by the 
+  // transition, loop and prune encodings, so only the elements that do not 
+  // occur below any of them can lose a direction, i.e. the propositional 
+  // structure of the formula around its temporal subformulas.
+  //
+  class clausal_encoder
+  {
+  public:
+    using literal = sat::dimacs::literal;
+
+    clausal_encoder(
+      encoder const& enc, sat::dimacs::solver &sat,
+      cnf_encoding encoding = cnf_encoding::tseitin
+    );
+
+    // Asserts the k-unraveling for the given k
+    void k_unraveling(size_t k);
+
+    // Defines EMPTY_k || LOOP_k and returns a literal that, when assumed,
+    // enforces it
+    literal k_empty_or_loop(size_t k);
+
+    // Asserts the negation of the PRUNE encoding
+    void k_not_prune(size_t k);
+
+    // Value of `f` at step `k` in the last model found by the backend
+    tribool value(formula f, size_t k) const;
+
+    // Value of the loop var for the loop from l to k
+    tribool loop_value(size_t l, size_t k) const;
+
+    // Values of `f` at steps [0, n) in the last model, appended to `out`
+    void values(formula f, size_t n, std::vector<tribool> &out) const;
+
+  private:
+    // A literal relative to the block of variables of a step
+    struct step_literal {
+      bool sign;
+      uint32_t offset;
+
+      friend step_literal operator!(step_literal l) {
+        return {!l.sign, l.offset};
+      }
+    };
+
+    // A literal of a clause template, relative to one of the blocks of
+    // variables given when the template is instantiated
+    struct template_literal {
+      bool sign;
+      uint8_t block;
+      uint32_t offset;
+
+      friend template_literal operator!(template_literal l) {
+        return {!l.sign, l.block, l.offset};
+      }
+    };
+
+    //
+    // A set of clauses parametric on the steps they refer to, stored flat.
+    // Each instance can also allocate a block of `fresh` new variables,
+    // referred to by `fresh_block`.
+    //
+    struct clause_template {
+      static constexpr uint8_t fresh_block = 3;
+
+      std::vector<template_literal> literals;
+      std::vector<size_t> ends; // one past the last literal of each clause
+      uint32_t fresh = 0;
+    };
+
+    // X-requests: the ground var, the operand, and the eventuality, if any
+    struct xrequest {
+      uint32_t var;
+      step_literal operand;
+      std::optional<step_literal> eventuality;
+      bool strong;
+    };
+
+    // Y/Z-requests: the ground var and the operand
+    struct yzrequest {
+      uint32_t var;
+      step_literal operand;
+    };
+
+    // Definition of a non-ground element: var <-> (a && (b || c)), or 
+    // var <-> (a && b) if c is missing
+    struct definition {
+      uint32_t var;
+      step_literal a;
+      step_literal b;
+      std::optional<step_literal> c;
+    };
+
+    // the backend receiving the clauses
+    sat::dimacs::solver &_sat;
+
+    // encode for finite models
+    bool _finite = false;
+
+    // kind of definitions of the non-ground elements
+    cnf_encoding _encoding = cnf_encoding::tseitin;
+
+    // the literal of the whole formula
+    step_literal _frm;
+
+    // step-relative literals of the closure elements
+    tsl::hopscotch_map<formula, step_literal> _closure;
+
+    // definitions of the non-ground elements, each after those of its 
+    // operands, added to the step template by _build_templates()
+    std::vector<definition> _definitions;
+
+    // requests from the closure
+    std::vector<xrequest> _xrequests;
+    std::vector<yzrequest> _yrequests;
+    std::vector<yzrequest> _zrequests;
+
+    // number of variables in the block of each step
+    uint32_t _block_size = 1; // offset 0 is the `true` variable
+
+    // first variable of the block of each step
+    std::vector<uint32_t> _blocks;
+
+    // offsets in the block of the variables referred to by later steps, 
+    // which are frozen in the backend
+    std::vector<uint32_t> _frozen;
+
+    // number of variables allocated in the backend so far
+    uint32_t _nvars = 0;
+
+    //
+    // Templates of the encoding, built once at construction. Blocks:
+    // - _step: 0 = k
+    // - _initial: 0 = 0
+    // - _transition: 0 = k, 1 = k - 1
+    // - _empty: 0 = k, the result is the first fresh variable
+    // - _loop: 0 = k, 1 = l, 2 = l + 1, the result is the last fresh variable
+    //
+    clause_template _step;
+    clause_template _initial;
+    clause_template _transition;
+    clause_template _empty;
+    clause_template _loop;
+
+    // buffer for the clauses sent to the backend
+    sat::dimacs::clause _buffer;
+
+    // literals for _lR_k, indexed by (l, k)
+    tsl::hopscotch_map<std::pair<size_t, size_t>, literal> _loops;
+
+    // loop vars, indexed by (l, k)
+    tsl::hopscotch_map<std::pair<size_t, size_t>, literal> _loop_vars;
+
+    // indexing of the closure
+    step_literal _index(formula f);
+    step_literal _ground(formula f);
+    step_literal _define_and(step_literal a, step_literal b);
+    step_literal _define_or(step_literal a, step_literal b);
+    step_literal _define_and_or(step_literal a, step_literal b, step_literal c);
+
+    // construction of the templates
+    static template_literal _at(step_literal l, uint8_t block);
+    static template_literal _fresh(clause_template &t);
+    static void _add(clause_template &t, 
+                     std::initializer_list<template_literal> lits);
+    static 
+    template_literal _conjoin(clause_template &t,
+                              std::vector<template_literal> const& lits);
+    static template_literal _equiv(clause_template &t, 
+                                   template_literal a, template_literal b);
+    void _build_definitions();
+    void _build_templates();
+
+    // instantiation of templates, returns the first fresh variable
+    uint32_t _instantiate(clause_template const& t, 
+                          std::array<uint32_t, 3> blocks = {});
+
+    // translation of step-relative literals
+    literal _lit(step_literal l, size_t k) const;
+    literal _top() const;
+
+    // allocation of variables and emission of clauses
+    uint32_t _alloc(uint32_t n);
+    void _clause(std::initializer_list<literal> lits);
+    void _clause(std::vector<literal> const& lits);
+
+    // Tseitin-style definitions of auxiliary literals
+    literal _and(std::vector<literal> const& lits);
+    literal _or(std::vector<literal> const& lits);
+
+    // pieces of the encoding
+    literal _l_to_k_loop(size_t l, size_t k);
+    literal _l_to_k_period(size_t l, size_t k);
+    literal _l_j_k_prune(size_t l, size_t j, size_t k);
+    literal _eventually_between(xrequest const& req, size_t b, size_t e);
+  };
+
+}
+
+#endif // BLACK_SOLVER_CLAUSAL_HPP
@@ -41,6 +41,8 @@ namespace black::internal {
   //
   struct encoder 
   {
+    friend class clausal_encoder;
+
     encoder(formula f, bool finite) 
       : _frm{f}, _sigma{_frm.sigma()}, _finite{finite}
     {
@@ -24,14 +24,33 @@
 #include <black/logic/cnf.hpp>
 #include <black/logic/alphabet.hpp>
 
+#include <tsl/hopscotch_map.h>
 #include <tsl/hopscotch_set.h>
 
 namespace black::internal 
 { 
+  //
+  // Polarities of the occurrences of a subformula, as a bitmask.
+  // Only the directions of the definition of the fresh variable that are 
+  // required by the polarity are emitted.
+  //
+  namespace {
+    enum polarity : uint8_t {
+      positive = 1,
+      negative = 2,
+      both = positive | negative
+    };
+  }
+
+  static polarity flip(polarity p) {
+    return polarity(((p & positive) << 1) | ((p & negative) >> 1));
+  }
+
   static void tseitin(
     formula f, 
-    std::vector<clause> &clauses, 
-    tsl::hopscotch_set<formula> &memo
+    polarity p,
+    cnf &clauses, 
+    tsl::hopscotch_map<formula, polarity> &memo
   );
 
   // TODO: disambiguate fresh variables
@@ -42,93 +61,170 @@ namespace black::internal
     return a;
   }
 
-  cnf to_cnf(formula f) {
-    std::vector<clause> result;
-    tsl::hopscotch_set<formula> memo;
+  cnf to_cnf(formula f, cnf_encoding encoding) {
+    cnf result;
+    to_cnf(f, result, encoding);
+
+    return result;
+  }
+
+  void to_cnf(formula f, cnf &result, cnf_encoding encoding) {
+    tsl::hopscotch_map<formula, polarity> memo;
     
     formula simple = simplify_deep(f);
     black_assert(simple.is<boolean>() || !has_constants(simple));
 
-    tseitin(simple, result, memo);
+    // The full Tseitin encoding is the Plaisted-Greenbaum one where every
+    // subformula occurs with both polarities
+    polarity p = 
+      encoding == cnf_encoding::tseitin ? polarity::both : polarity::positive;
+
+    tseitin(simple, p, result, memo);
     if(auto b = simple.to<boolean>(); b) {
-      if(b->value())
-        return result;
-      else {
-        result.push_back({});
-        return result;
-      }
+      if(!b->value())
+        result.add_clause({});
+      return;
     }
 
-    result.push_back({{true, fresh(simple)}});
+    result.add_clause({{true, fresh(simple)}});
+  }
+
+  //
+  // Operands of the maximal chain of conjunctions (or disjunctions) rooted 
+  // at `f`, so that the whole chain gets a single n-ary definition.
+  // Subchains shared inside the chain are visited once, and duplicate 
+  // operands are dropped.
+  //
+  template<typename T>
+  static std::vector<formula> operands(T f) {
+    std::vector<formula> result;
+    tsl::hopscotch_set<formula> seen;
+    std::vector<formula> stack = {f.right(), f.left()};
+
+    while(!stack.empty()) {
+      formula g = stack.back();
+      stack.pop_back();
+
+      if(!seen.insert(g).second)
+        continue;
 
-    return {result};
+      if(auto t = g.to<T>(); t) {
+        stack.push_back(t->right());
+        stack.push_back(t->left());
+      } else
+        result.push_back(g);
+    }
+
+    return result;
   }
 
   static void tseitin(
     formula f, 
-    std::vector<clause> &clauses, 
-    tsl::hopscotch_set<formula> &memo
+    polarity p,
+    cnf &clauses, 
+    tsl::hopscotch_map<formula, polarity> &memo
   ) {
-    if(memo.find(f) != memo.end())
+    polarity done = polarity(0);
+    if(auto it = memo.find(f); it != memo.end())
+      done = it->second;
+
+    // the directions of the definition not emitted yet
+    polarity todo = polarity(p & ~done);
+    if(todo == 0)
       return;
 
-    memo.insert(f);
+    memo[f] = polarity(done | todo);
+    
+    bool pos = (todo & positive) != 0;
+    bool neg = (todo & negative) != 0;
+
+    auto recurse = [&](formula child, polarity cp) {
+      tseitin(child, cp, clauses, memo);
+    };
+
+    // Emits the directions of v <-> (l1 ∧ ... ∧ ln), where each li is the
+    // fresh variable of the i-th operand, negated if `sign` is false
+    auto define_and = [&](
+      literal v, std::vector<formula> const& ops, bool sign, 
+      bool forward, bool backward
+    ) {
+      if(forward)
+        for(formula op : ops)
+          clauses.add_clause({!v, {sign, fresh(op)}});
+      
+      if(backward) {
+        clauses.push_literal(v);
+        for(formula op : ops)
+          clauses.push_literal({!sign, fresh(op)});
+        clauses.end_clause();
+      }
+    };
+
     f.match(
       [](boolean) { },
       [](atom)  {  },
-      [&](conjunction, formula l, formula r) 
+      [&](conjunction c) 
       {
-        tseitin(l, clauses, memo);
-        tseitin(r, clauses, memo);
+        std::vector<formula> ops = operands(c);
+        for(formula op : ops)
+          recurse(op, todo);
 
         // clausal form for conjunctions:
-        //   f <-> (l ∧ r) == (!f ∨ l) ∧ (!f ∨ r) ∧ (!l ∨ !r ∨ f)
-        clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-          {{false, fresh(f)}, {true, fresh(l)}},
-          {{false, fresh(f)}, {true, fresh(r)}},
-          {{false, fresh(l)}, {false, fresh(r)}, {true, fresh(f)}}
-        });
+        //   f <-> (l1 ∧ ... ∧ ln) == (!f ∨ l1) ∧ ... ∧ (!f ∨ ln) ∧ 
+        //                            (!l1 ∨ ... ∨ !ln ∨ f)
+        define_and({true, fresh(f)}, ops, true, pos, neg);
       },
-      [&](disjunction, formula l, formula r) 
+      [&](disjunction d) 
       {
-        tseitin(l, clauses, memo);
-        tseitin(r, clauses, memo);
+        std::vector<formula> ops = operands(d);
+        for(formula op : ops)
+          recurse(op, todo);
 
         // clausal form for disjunctions:
-        //   f <-> (l ∨ r) == (f ∨ !l) ∧ (f ∨ !r) ∧ (l ∨ r ∨ !f)
-        clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-          {{true, fresh(f)}, {false, fresh(l)}},
-          {{true, fresh(f)}, {false, fresh(r)}},
-          {{true, fresh(l)}, {true, fresh(r)}, {false, fresh(f)}}
-        });
+        //   f <-> (l1 ∨ ... ∨ ln) == (f ∨ !l1) ∧ ... ∧ (f ∨ !ln) ∧ 
+        //                            (l1 ∨ ... ∨ ln ∨ !f)
+        define_and({false, fresh(f)}, ops, false, neg, pos);
       },
       [&](implication, formula l, formula r) 
       {
-        tseitin(l, clauses, memo);
-        tseitin(r, clauses, memo);
+        recurse(l, flip(todo));
+        recurse(r, todo);
 
         // clausal form for double implications:
         //    f <-> (l -> r) == (!f ∨ !l ∨ r) ∧ (f ∨ l) ∧ (f ∨ !r)
-        clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-          {{false, fresh(f)}, {false, fresh(l)}, {true, fresh(r)}},
-          {{true,  fresh(f)}, {true,  fresh(l)}},
-          {{true,  fresh(f)}, {false, fresh(r)}}
-        });     
+        if(pos)
+          clauses.add_clause(
+            {{false, fresh(f)}, {false, fresh(l)}, {true, fresh(r)}}
+          );
+        if(neg) {
+          clauses.add_clause({{true,  fresh(f)}, {true,  fresh(l)}});
+          clauses.add_clause({{true,  fresh(f)}, {false, fresh(r)}});
+        }     
       },
       [&](iff, formula l, formula r) 
       {
-        tseitin(l, clauses, memo);
-        tseitin(r, clauses, memo);
+        recurse(l, polarity::both);
+        recurse(r, polarity::both);
 
         // clausal form for double implications:
         //    f <-> (l <-> r) == (!f ∨ !l ∨  r) ∧ (!f ∨ l ∨ !r) ∧
         //                       ( f ∨ !l ∨ !r) ∧ ( f ∨ l ∨  r)
-        clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-          {{false, fresh(f)}, {false, fresh(l)}, {true,  fresh(r)}},
-          {{false, fresh(f)}, {true,  fresh(l)}, {false, fresh(r)}},
-          {{true,  fresh(f)}, {false, fresh(l)}, {false, fresh(r)}},
-          {{true,  fresh(f)}, {true,  fresh(l)}, {true,  fresh(r)}}
-        });
+        if(pos) {
+          clauses.add_clause(
+            {{false, fresh(f)}, {false, fresh(l)}, {true,  fresh(r)}}
+          );
+          clauses.add_clause(
+            {{false, fresh(f)}, {true,  fresh(l)}, {false, fresh(r)}}
+          );
+        }
+        if(neg) {
+          clauses.add_clause(
+            {{true,  fresh(f)}, {false, fresh(l)}, {false, fresh(r)}}
+          );
+          clauses.add_clause(
+            {{true,  fresh(f)}, {true,  fresh(l)}, {true,  fresh(r)}}
+          );
+        }
       },
       [&](negation, formula arg) {
         return arg.match(
@@ -136,73 +232,82 @@ namespace black::internal
           [&](atom a) {
             // clausal form for negations:
             // f <-> !p == (!f ∨ !p) ∧ (f ∨ p)
-            clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-              {{false, fresh(f)}, {false, fresh(a)}},
-              {{true,  fresh(f)}, {true,  fresh(a)}}
-            });
+            if(pos)
+              clauses.add_clause({{false, fresh(f)}, {false, fresh(a)}});
+            if(neg)
+              clauses.add_clause({{true,  fresh(f)}, {true,  fresh(a)}});
           },
           [&](negation, formula op) {
-            tseitin(op, clauses, memo);
+            recurse(op, todo);
 
             // NOTE: normally, this case should never be invoked because 
             //       simplify_deep() removes double negations
             // clausal form for identity:
             // f <-> p == (!f ∨ p) ∧ (f ∨ !p)
-            clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-              {{false, fresh(f)}, {true, fresh(op)}},
-              {{true,  fresh(f)}, {false,  fresh(op)}}
-            });
+            if(pos)
+              clauses.add_clause({{false, fresh(f)}, {true, fresh(op)}});
+            if(neg)
+              clauses.add_clause({{true,  fresh(f)}, {false,  fresh(op)}});
           },
-          [&](conjunction, formula l, formula r) {
-            tseitin(l, clauses, memo);
-            tseitin(r, clauses, memo);
+          [&](conjunction c) {
+            std::vector<formula> ops = operands(c);
+            for(formula op : ops)
+              recurse(op, flip(todo));
 
             // clausal form for negated conjunction:
-            //   f <-> !(l ∧ r) == (!f ∨ !l ∨ !r) ∧ (f ∨ l) ∧ (f ∨ r)
-            clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-              {{false, fresh(f)}, {false, fresh(l)}, {false, fresh(r)}},
-              {{true,  fresh(f)}, {true, fresh(l)}},
-              {{true,  fresh(f)}, {true, fresh(r)}},
-            });
+            //   f <-> !(l1 ∧ ... ∧ ln) == (!f ∨ !l1 ∨ ... ∨ !ln) ∧ 
+            //                             (f ∨ l1) ∧ ... ∧ (f ∨ ln)
+            define_and({false, fresh(f)}, ops, true, neg, pos);
           },
-          [&](disjunction, formula l, formula r) {
-            tseitin(l, clauses, memo);
-            tseitin(r, clauses, memo);
+          [&](disjunction d) {
+            std::vector<formula> ops = operands(d);
+            for(formula op : ops)
+              recurse(op, flip(todo));
 
             // clausal form for negated disjunction:
-            //   f <-> !(l ∨ r) == (f ∨ l ∨ r) ∧ (!f ∨ !l) ∧ (!f ∨ !r)
-            clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-              {{true,  fresh(f)}, {true,  fresh(l)}, {true, fresh(r)}},
-              {{false, fresh(f)}, {false, fresh(l)}},
-              {{false, fresh(f)}, {false, fresh(r)}},
-            });
+            //   f <-> !(l1 ∨ ... ∨ ln) == (f ∨ l1 ∨ ... ∨ ln) ∧ 
+            //                             (!f ∨ !l1) ∧ ... ∧ (!f ∨ !ln)
+            define_and({true, fresh(f)}, ops, false, pos, neg);
           },
           [&](implication, formula l, formula r) 
           {
-            tseitin(l, clauses, memo);
-            tseitin(r, clauses, memo);
+            recurse(l, todo);
+            recurse(r, flip(todo));
 
             // clausal form for negated implication:
-            //   f <-> (l ∧ r) == (!f ∨ l) ∧ (!f ∨ !r) ∧ (!l ∨ r ∨ f)
-            clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-              {{false, fresh(f)}, {true, fresh(l)}},
-              {{false, fresh(f)}, {false, fresh(r)}},
-              {{false, fresh(l)}, {true, fresh(r)}, {true, fresh(f)}}
-            });
+            //   f <-> !(l -> r) == (!f ∨ l) ∧ (!f ∨ !r) ∧ (!l ∨ r ∨ f)
+            if(pos) {
+              clauses.add_clause({{false, fresh(f)}, {true, fresh(l)}});
+              clauses.add_clause({{false, fresh(f)}, {false, fresh(r)}});
+            }
+            if(neg)
+              clauses.add_clause(
+                {{false, fresh(l)}, {true, fresh(r)}, {true, fresh(f)}}
+              );
           },
           [&](iff, formula l, formula r) {
-            tseitin(l, clauses, memo);
-            tseitin(r, clauses, memo);
+            recurse(l, polarity::both);
+            recurse(r, polarity::both);
 
             // clausal form for negated double implication (xor):
             //    f <-> !(l <-> r) == (!f ∨ !l ∨ !r) ∧ (!f ∨  l ∨ r) ∧
             //                        (f  ∨  l ∨ !r) ∧ (f  ∨ !l ∨ r)
-            clauses.insert(clauses.end(), { // LCOV_EXCL_LINE
-              {{false, fresh(f)}, {false, fresh(l)}, {false, fresh(r)}},
-              {{false, fresh(f)}, {true,  fresh(l)}, {true,  fresh(r)}},
-              {{true,  fresh(f)}, {true,  fresh(l)}, {false, fresh(r)}},
-              {{true,  fresh(f)}, {false, fresh(l)}, {true,  fresh(r)}}
-            });
+            if(pos) {
+              clauses.add_clause(
+                {{false, fresh(f)}, {false, fresh(l)}, {false, fresh(r)}}
+              );
+              clauses.add_clause(
+                {{false, fresh(f)}, {true,  fresh(l)}, {true,  fresh(r)}}
+              );
+            }
+            if(neg) {
+              clauses.add_clause(
+                {{true,  fresh(f)}, {true,  fresh(l)}, {false, fresh(r)}}
+              );
+              clauses.add_clause(
+                {{true,  fresh(f)}, {false, fresh(l)}, {true,  fresh(r)}}
+              );
+            }
           },
           [](temporal) { black_unreachable(); } // LCOV_EXCL_LINE
         );
@@ -211,18 +316,19 @@ namespace black::internal
     );
   }
 
-  formula to_formula(literal lit) {
-    return lit.sign ? formula{lit.atom} : formula{!lit.atom};
+  formula to_formula(alphabet &sigma, literal lit) {
+    atom a = lit.atom(sigma);
+    return lit.sign() ? formula{a} : formula{!a};
   }
 
   formula to_formula(alphabet &sigma, clause c) {
-    return big_or(sigma, c.literals, [](literal lit){
-      return to_formula(lit);
+    return big_or(sigma, c.begin(), c.end(), [&](literal lit){
+      return to_formula(sigma, lit);
     });
   }
 
-  formula to_formula(alphabet &sigma, cnf c) {
-    return big_and(sigma, c.clauses, [&](clause cl) {
+  formula to_formula(alphabet &sigma, cnf const& c) {
+    return big_and(sigma, c.begin(), c.end(), [&](clause cl) {
       return to_formula(sigma, cl);
     });
   }
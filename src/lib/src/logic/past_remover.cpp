@@ -24,38 +24,68 @@
 #include <black/logic/past_remover.hpp>
 
 #include <numeric>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace black::internal {
-  formula sub_past(formula f) {
+
+  // Memoized implementation of sub_past(), so that subformulas shared by
+  // different parts of the formula are translated only once
+  static 
+  formula sub_past(formula f, std::unordered_map<formula, formula> &memo) {
+    if(auto it = memo.find(f); it != memo.end())
+      return it->second;
+
     alphabet *alpha = f.sigma();
 
-    return f.match(
+    formula result = f.match(
         [&](yesterday, formula op) {
-          return alpha->var(past_label{Y(sub_past(op))});
+          return alpha->var(past_label{Y(sub_past(op, memo))});
         },
         [&](w_yesterday, formula op) {
-          return alpha->var(past_label{Z(sub_past(op))});
+          return alpha->var(past_label{Z(sub_past(op, memo))});
         },
         [&](since, formula left, formula right) {
-          return alpha->var(past_label{S(sub_past(left), sub_past(right))});
+          return alpha->var(
+            past_label{S(sub_past(left, memo), sub_past(right, memo))}
+          );
         },
-        [](triggered, formula left, formula right) {
-          return sub_past(!S(!left, !right));
+        [&](triggered, formula left, formula right) {
+          return sub_past(!S(!left, !right), memo);
         },
-        [](once p, formula op) { return sub_past(S(p.sigma()->top(), op)); },
-        [](historically, formula op) { return sub_past(!O(!op)); },
+        [&](once p, formula op) { 
+          return sub_past(S(p.sigma()->top(), op), memo); 
+        },
+        [&](historically, formula op) { return sub_past(!O(!op), memo); },
         [](boolean b) { return b; },
         [](atom a) { return a; },
-        [](unary u, formula op) {
-          return unary(u.formula_type(), sub_past(op));
+        [&](unary u, formula op) {
+          return unary(u.formula_type(), sub_past(op, memo));
         },
-        [](binary b, formula left, formula right) {
-          return binary(b.formula_type(), sub_past(left), sub_past(right));
+        [&](binary b, formula left, formula right) {
+          return binary(
+            b.formula_type(), sub_past(left, memo), sub_past(right, memo)
+          );
         }
     );
+
+    memo.insert({f, result});
+    return result;
   }
 
-  void gen_semantics(formula f, std::vector<formula> &sem) {
+  formula sub_past(formula f) {
+    std::unordered_map<formula, formula> memo;
+    return sub_past(f, memo);
+  }
+
+  // Implementation of gen_semantics(). Each subformula is visited once, so
+  // the semantics of each translator atom is generated only once.
+  static void gen_semantics(
+    formula f, std::vector<formula> &sem, std::unordered_set<formula> &visited
+  ) {
+    if(!visited.insert(f).second)
+      return;
+
     return f.match(
         [](boolean) {},
         [&](atom a) {
@@ -70,38 +100,44 @@ namespace black::internal {
 
                 sem.push_back(sem_y);
 
-                gen_semantics(op, sem);
+                gen_semantics(op, sem, visited);
               },
               [&](w_yesterday z, formula op) {
                 formula sem_z = w_yesterday_semantics(a, z);
 
                 sem.push_back(sem_z);
 
-                gen_semantics(op, sem);
+                gen_semantics(op, sem, visited);
               },
               [&](since s, formula left, formula right) {
                 alphabet *alpha = f.sigma();
                 atom y = alpha->var(past_label{Y(a)});
                 formula sem_s = since_semantics(a, s, y);
-                formula sem_y = yesterday_semantics(y, Y(a));
 
                 sem.push_back(sem_s);
-                sem.push_back(sem_y);
 
-                gen_semantics(left, sem);
-                gen_semantics(right, sem);
+                // the semantics of `y` is generated here unless it has 
+                // already been, since `y` may also occur elsewhere
+                gen_semantics(y, sem, visited);
+                gen_semantics(left, sem, visited);
+                gen_semantics(right, sem, visited);
               },
               [](otherwise) { black_unreachable(); } // LCOV_EXCL_LINE
           );
         },
-        [&](unary, formula op) { gen_semantics(op, sem); },
+        [&](unary, formula op) { gen_semantics(op, sem, visited); },
         [&](binary, formula left, formula right) {
-          gen_semantics(left, sem);
-          gen_semantics(right, sem);
+          gen_semantics(left, sem, visited);
+          gen_semantics(right, sem, visited);
         }
     );
   }
 
+  void gen_semantics(formula f, std::vector<formula> &sem) {
+    std::unordered_set<formula> visited;
+    gen_semantics(f, sem, visited);
+  }
+
   formula remove_past(formula f) {
     formula ltl = sub_past(f);
 
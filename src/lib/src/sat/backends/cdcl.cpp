@@ -0,0 +1,686 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <black/sat/backends/cdcl.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+BLACK_REGISTER_SAT_BACKEND(cdcl)
+
+namespace black::sat::backends
+{
+  namespace {
+    // Literals are encoded as 2 * var + 1 if negative, 2 * var if positive, 
+    // so that the negation of a literal only flips the last bit
+    using lit_t = uint32_t;
+    
+    constexpr lit_t no_lit = std::numeric_limits<lit_t>::max();
+
+    lit_t mklit(uint32_t var, bool sign) { return 2 * var + !sign; }
+    uint32_t var(lit_t l) { return l >> 1; }
+    bool sign(lit_t l) { return (l & 1) == 0; }
+    lit_t neg(lit_t l) { return l ^ 1; }
+
+    // Clauses are stored contiguously in an arena, and referred to by the 
+    // offset of their header. The header holds the size and the learnt flag,
+    // followed by the LBD of the clause, and then by its literals.
+    using cref_t = uint32_t;
+
+    constexpr cref_t no_reason = std::numeric_limits<cref_t>::max();
+    constexpr size_t header_size = 2;
+
+    struct watcher {
+      cref_t cref;
+      lit_t blocker; // if true, the clause is satisfied and can be skipped
+    };
+
+    // max-heap of variables ordered by activity, for VSIDS decisions
+    class var_heap {
+    public:
+      var_heap(std::vector<double> const& activity) : _activity{activity} { }
+
+      bool empty() const { return _heap.empty(); }
+      bool contains(uint32_t v) const { 
+        return v < _pos.size() && _pos[v] >= 0; 
+      }
+
+      void insert(uint32_t v) {
+        if(v >= _pos.size())
+          _pos.resize(v + 1, -1);
+        if(contains(v))
+          return;
+        
+        _pos[v] = static_cast<int32_t>(_heap.size());
+        _heap.push_back(v);
+        up(_heap.size() - 1);
+      }
+
+      // to be called after increasing the activity of `v`
+      void increased(uint32_t v) {
+        if(contains(v))
+          up(static_cast<size_t>(_pos[v]));
+      }
+
+      uint32_t pop() {
+        uint32_t top = _heap[0];
+        _heap[0] = _heap.back();
+        _pos[_heap[0]] = 0;
+        _heap.pop_back();
+        _pos[top] = -1;
+        if(!_heap.empty())
+          down(0);
+
+        return top;
+      }
+
+    private:
+      bool before(uint32_t v1, uint32_t v2) const {
+        return _activity[v1] > _activity[v2];
+      }
+
+      void up(size_t i) {
+        uint32_t v = _heap[i];
+        while(i > 0 && before(v, _heap[(i - 1) / 2])) {
+          _heap[i] = _heap[(i - 1) / 2];
+          _pos[_heap[i]] = static_cast<int32_t>(i);
+          i = (i - 1) / 2;
+        }
+        _heap[i] = v;
+        _pos[v] = static_cast<int32_t>(i);
+      }
+
+      void down(size_t i) {
+        uint32_t v = _heap[i];
+        while(2 * i + 1 < _heap.size()) {
+          size_t child = 2 * i + 1;
+          if(child + 1 < _heap.size() && before(_heap[child + 1], _heap[child]))
+            child++;
+          if(!before(_heap[child], v))
+            break;
+          _heap[i] = _heap[child];
+          _pos[_heap[i]] = static_cast<int32_t>(i);
+          i = child;
+        }
+        _heap[i] = v;
+        _pos[v] = static_cast<int32_t>(i);
+      }
+
+      std::vector<double> const& _activity;
+      std::vector<uint32_t> _heap;
+      std::vector<int32_t> _pos;
+    };
+
+    // the Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, ... used for restarts
+    double luby(double y, uint64_t x) {
+      uint64_t size = 1;
+      int seq = 0;
+      while(size < x + 1) {
+        seq++;
+        size = 2 * size + 1;
+      }
+
+      while(size - 1 != x) {
+        size = (size - 1) >> 1;
+        seq--;
+        x = x % size;
+      }
+
+      return std::pow(y, seq);
+    }
+  }
+
+  struct cdcl::_cdcl_t 
+  {
+    // clause database
+    std::vector<uint32_t> arena;
+    std::vector<cref_t> clauses;
+    std::vector<cref_t> learnts;
+    std::vector<std::vector<watcher>> watches; // indexed by literal
+
+    // assignment
+    std::vector<int8_t> values; // indexed by literal: 1 true, -1 false
+    std::vector<uint32_t> levels; // indexed by var
+    std::vector<cref_t> reasons; // indexed by var
+    std::vector<lit_t> trail;
+    std::vector<size_t> trail_lim; // start of each decision level
+    size_t qhead = 0;
+
+    // decision heuristics
+    std::vector<double> activity; // indexed by var
+    std::vector<bool> phases; // indexed by var, the last assigned sign
+    var_heap heap{activity};
+    double var_inc = 1;
+    size_t max_learnts = 0;
+
+    // buffers for conflict analysis
+    std::vector<uint8_t> seen; // indexed by var
+    std::vector<lit_t> learnt;
+    std::vector<lit_t> to_clear;
+    std::vector<uint64_t> level_stamps; // indexed by level, to compute LBDs
+    uint64_t stamp = 0;
+
+    // buffer for adding clauses
+    std::vector<lit_t> lits;
+
+    std::vector<int8_t> model; // indexed by var, empty if not available
+    uint32_t nvars = 0;
+    bool ok = true; // false if the clauses are unsatisfiable at level 0
+
+    _cdcl_t() { new_vars(0); }
+
+    void new_vars(size_t n);
+    void add_clause(std::vector<lit_t> &lits);
+    bool solve(std::vector<lit_t> const& assumptions);
+
+    int8_t value(lit_t l) const { return values[l]; }
+    uint32_t level() const { return static_cast<uint32_t>(trail_lim.size()); }
+    uint32_t size(cref_t c) const { return arena[c] >> 1; }
+    bool learnt_clause(cref_t c) const { return arena[c] & 1; }
+    uint32_t lbd(cref_t c) const { return arena[c + 1]; }
+    lit_t *literals(cref_t c) { return &arena[c + header_size]; }
+
+    cref_t alloc(std::vector<lit_t> const& lits, bool learnt, uint32_t lbd);
+    void attach(cref_t c);
+    void assign(lit_t l, cref_t reason);
+    cref_t propagate();
+    void analyze(cref_t confl, uint32_t &bt_level, uint32_t &lbd);
+    bool redundant(lit_t l);
+    void cancel(uint32_t level);
+    lit_t pick_branch();
+    void bump(uint32_t v);
+    void reduce();
+    tribool search(uint64_t budget, std::vector<lit_t> const& assumptions);
+  };
+
+  void cdcl::_cdcl_t::new_vars(size_t n) {
+    black_assert(nvars + n < std::numeric_limits<int32_t>::max());
+    
+    // var 0 is never used
+    size_t total = nvars + n + 1;
+    watches.resize(2 * total);
+    values.resize(2 * total, 0);
+    levels.resize(total, 0);
+    reasons.resize(total, no_reason);
+    activity.resize(total, 0);
+    phases.resize(total, false);
+    seen.resize(total, 0);
+
+    for(size_t i = 0; i < n; ++i)
+      heap.insert(++nvars);
+  }
+
+  cref_t cdcl::_cdcl_t::alloc(
+    std::vector<lit_t> const& clause, bool learnt, uint32_t clause_lbd
+  ) {
+    black_assert(arena.size() < no_reason);
+    
+    cref_t c = static_cast<cref_t>(arena.size());
+    arena.push_back(static_cast<uint32_t>(clause.size() << 1) | learnt);
+    arena.push_back(clause_lbd);
+    arena.insert(arena.end(), clause.begin(), clause.end());
+
+    return c;
+  }
+
+  void cdcl::_cdcl_t::attach(cref_t c) {
+    lit_t *lits = literals(c);
+    watches[lits[0]].push_back({c, lits[1]});
+    watches[lits[1]].push_back({c, lits[0]});
+  }
+
+  void cdcl::_cdcl_t::assign(lit_t l, cref_t reason) {
+    values[l] = 1;
+    values[neg(l)] = -1;
+    levels[var(l)] = level();
+    reasons[var(l)] = reason;
+    trail.push_back(l);
+  }
+
+  // clauses are only added at level 0, between calls to solve()
+  void cdcl::_cdcl_t::add_clause(std::vector<lit_t> &clause) {
+    if(!ok)
+      return;
+
+    // drop duplicate and false literals, and tautological or true clauses
+    std::sort(clause.begin(), clause.end());
+    size_t j = 0;
+    for(size_t i = 0; i < clause.size(); ++i) {
+      lit_t l = clause[i];
+      if(value(l) > 0 || (j > 0 && clause[j - 1] == neg(l)))
+        return;
+      if(value(l) < 0 || (j > 0 && clause[j - 1] == l))
+        continue;
+      clause[j++] = l;
+    }
+    clause.resize(j);
+
+    if(clause.empty()) {
+      ok = false;
+      return;
+    }
+
+    if(clause.size() == 1) {
+      assign(clause[0], no_reason);
+      ok = (propagate() == no_reason);
+      return;
+    }
+
+    cref_t c = alloc(clause, false, 0);
+    clauses.push_back(c);
+    attach(c);
+  }
+
+  //
+  // Unit propagation with two watched literals. The watched literals of 
+  // each clause are the first two, and the literal implied by a clause 
+  // is always the first one, as required by the conflict analysis.
+  //
+  cref_t cdcl::_cdcl_t::propagate() {
+    cref_t confl = no_reason;
+    
+    while(qhead < trail.size()) {
+      lit_t false_lit = neg(trail[qhead++]);
+      std::vector<watcher> &ws = watches[false_lit];
+
+      size_t i = 0, j = 0, n = ws.size();
+      while(i < n) {
+        watcher w = ws[i++];
+        if(value(w.blocker) > 0) {
+          ws[j++] = w;
+          continue;
+        }
+
+        lit_t *lits = literals(w.cref);
+        if(lits[0] == false_lit)
+          std::swap(lits[0], lits[1]);
+
+        lit_t first = lits[0];
+        watcher nw = {w.cref, first};
+        if(first != w.blocker && value(first) > 0) {
+          ws[j++] = nw;
+          continue;
+        }
+
+        // look for a new literal to watch
+        bool found = false;
+        for(uint32_t k = 2, sz = size(w.cref); k < sz; ++k) {
+          if(value(lits[k]) >= 0) {
+            lits[1] = lits[k];
+            lits[k] = false_lit;
+            watches[lits[1]].push_back(nw);
+            found = true;
+            break;
+          }
+        }
+        if(found)
+          continue;
+
+        // the clause is unit or conflicting
+        ws[j++] = nw;
+        if(value(first) < 0) {
+          confl = w.cref;
+          qhead = trail.size();
+          while(i < n)
+            ws[j++] = ws[i++];
+        } else
+          assign(first, w.cref);
+      }
+      ws.resize(j);
+    }
+
+    return confl;
+  }
+
+  void cdcl::_cdcl_t::bump(uint32_t v) {
+    activity[v] += var_inc;
+    if(activity[v] > 1e100) {
+      for(double &a : activity)
+        a *= 1e-100;
+      var_inc *= 1e-100;
+    }
+    heap.increased(v);
+  }
+
+  // A literal of the learnt clause is redundant if it is implied by the 
+  // other literals of the clause, i.e. if all the other literals of its 
+  // reason are in the clause as well, or are false at level 0
+  bool cdcl::_cdcl_t::redundant(lit_t l) {
+    cref_t reason = reasons[var(l)];
+    if(reason == no_reason)
+      return false;
+
+    lit_t *lits = literals(reason);
+    for(uint32_t k = 1, sz = size(reason); k < sz; ++k) {
+      uint32_t v = var(lits[k]);
+      if(!seen[v] && levels[v] > 0)
+        return false;
+    }
+    return true;
+  }
+
+  //
+  // First-UIP conflict analysis. On return, `learnt` holds the learnt 
+  // clause, with the asserting literal first and a literal of the 
+  // backtracking level second.
+  //
+  void cdcl::_cdcl_t::analyze(cref_t confl, uint32_t &bt_level, uint32_t &lbd)
+  {
+    learnt.clear();
+    learnt.push_back(no_lit);
+
+    size_t path = 0;
+    lit_t p = no_lit;
+    size_t index = trail.size();
+
+    do {
+      black_assert(confl != no_reason);
+      lit_t *lits = literals(confl);
+      for(uint32_t k = (p == no_lit ? 0 : 1), sz = size(confl); k < sz; ++k) {
+        lit_t q = lits[k];
+        uint32_t v = var(q);
+        if(seen[v] || levels[v] == 0)
+          continue;
+        
+        bump(v);
+        seen[v] = 1;
+        if(levels[v] >= level())
+          path++;
+        else
+          learnt.push_back(q);
+      }
+
+      // next literal of the current level to look at
+      while(!seen[var(trail[--index])]);
+      p = trail[index];
+      confl = reasons[var(p)];
+      seen[var(p)] = 0;
+      path--;
+    } while(path > 0);
+    learnt[0] = neg(p);
+
+    // drop the redundant literals
+    to_clear.assign(learnt.begin(), learnt.end());
+    size_t j = 1;
+    for(size_t i = 1; i < learnt.size(); ++i)
+      if(!redundant(learnt[i]))
+        learnt[j++] = learnt[i];
+    learnt.resize(j);
+
+    for(lit_t l : to_clear)
+      seen[var(l)] = 0;
+
+    // find the backtracking level
+    bt_level = 0;
+    if(learnt.size() > 1) {
+      size_t max = 1;
+      for(size_t i = 2; i < learnt.size(); ++i)
+        if(levels[var(learnt[i])] > levels[var(learnt[max])])
+          max = i;
+      std::swap(learnt[1], learnt[max]);
+      bt_level = levels[var(learnt[1])];
+    }
+
+    // the number of distinct levels in the clause
+    if(level_stamps.size() <= level())
+      level_stamps.resize(level() + 1, 0);
+    stamp++;
+    lbd = 0;
+    for(lit_t l : learnt) {
+      uint32_t lvl = levels[var(l)];
+      if(level_stamps[lvl] != stamp) {
+        level_stamps[lvl] = stamp;
+        lbd++;
+      }
+    }
+  }
+
+  void cdcl::_cdcl_t::cancel(uint32_t lvl) {
+    if(level() <= lvl)
+      return;
+
+    for(size_t i = trail.size(); i-- > trail_lim[lvl];) {
+      lit_t l = trail[i];
+      uint32_t v = var(l);
+      values[l] = values[neg(l)] = 0;
+      reasons[v] = no_reason;
+      phases[v] = sign(l);
+      heap.insert(v);
+    }
+    trail.resize(trail_lim[lvl]);
+    trail_lim.resize(lvl);
+    qhead = trail.size();
+  }
+
+  lit_t cdcl::_cdcl_t::pick_branch() {
+    while(!heap.empty()) {
+      uint32_t v = heap.pop();
+      if(values[mklit(v, true)] == 0)
+        return mklit(v, phases[v]);
+    }
+    return no_lit;
+  }
+
+  //
+  // Removes the clauses satisfied at level 0, and half of the learnt clauses,
+  // keeping those with the lowest LBD. Then the arena is compacted and the 
+  // watches rebuilt. It must be called at level 0, after propagation.
+  //
+  void cdcl::_cdcl_t::reduce() {
+    black_assert(level() == 0);
+
+    std::sort(learnts.begin(), learnts.end(), [&](cref_t c1, cref_t c2) {
+      return lbd(c1) < lbd(c2);
+    });
+
+    size_t keep = learnts.size() / 2;
+    while(keep < learnts.size() && lbd(learnts[keep]) <= 2)
+      keep++;
+    learnts.resize(keep);
+
+    std::vector<uint32_t> old_arena;
+    std::swap(old_arena, arena);
+    for(auto &ws : watches)
+      ws.clear();
+
+    // reasons of level 0 literals are never looked at again
+    for(lit_t l : trail)
+      reasons[var(l)] = no_reason;
+
+    auto move = [&](std::vector<cref_t> &crefs, bool learnt) {
+      size_t j = 0;
+      for(cref_t c : crefs) {
+        uint32_t sz = old_arena[c] >> 1;
+        uint32_t *begin = &old_arena[c + header_size];
+        
+        // false literals at level 0 can be dropped
+        lits.clear();
+        bool satisfied = false;
+        for(uint32_t *it = begin; it != begin + sz; ++it) {
+          if(value(*it) > 0)
+            satisfied = true;
+          if(value(*it) == 0)
+            lits.push_back(*it);
+        }
+        if(satisfied)
+          continue;
+
+        black_assert(lits.size() >= 2);
+        crefs[j] = alloc(lits, learnt, old_arena[c + 1]);
+        attach(crefs[j++]);
+      }
+      crefs.resize(j);
+    };
+
+    move(clauses, false);
+    move(learnts, true);
+
+    max_learnts += max_learnts / 10;
+  }
+
+  //
+  // Search until a model is found, the clauses are found unsatisfiable 
+  // under the assumptions, or the budget of conflicts is exhausted.
+  //
+  tribool cdcl::_cdcl_t::search(
+    uint64_t budget, std::vector<lit_t> const& assumptions
+  ) {
+    uint64_t conflicts = 0;
+    for(;;) {
+      cref_t confl = propagate();
+      if(confl != no_reason) {
+        conflicts++;
+        if(level() == 0) {
+          ok = false;
+          return false;
+        }
+
+        uint32_t bt_level, clause_lbd;
+        analyze(confl, bt_level, clause_lbd);
+        cancel(bt_level);
+
+        if(learnt.size() == 1)
+          assign(learnt[0], no_reason);
+        else {
+          cref_t c = alloc(learnt, true, clause_lbd);
+          learnts.push_back(c);
+          attach(c);
+          assign(learnt[0], c);
+        }
+
+        var_inc /= 0.95;
+        continue;
+      }
+
+      if(conflicts >= budget) {
+        cancel(0);
+        return tribool::undef;
+      }
+
+      if(level() == 0 && learnts.size() >= max_learnts + trail.size())
+        reduce();
+
+      // the assumptions are the first decisions
+      lit_t next = no_lit;
+      while(level() < assumptions.size()) {
+        lit_t p = assumptions[level()];
+        if(value(p) > 0) 
+          trail_lim.push_back(trail.size());
+        else if(value(p) < 0)
+          return false;
+        else {
+          next = p;
+          break;
+        }
+      }
+
+      if(next == no_lit) {
+        next = pick_branch();
+        if(next == no_lit) 
+          return true;
+      }
+
+      trail_lim.push_back(trail.size());
+      assign(next, no_reason);
+    }
+  }
+
+  bool cdcl::_cdcl_t::solve(std::vector<lit_t> const& assumptions) {
+    model.clear();
+    if(!ok)
+      return false;
+
+    max_learnts = std::max(max_learnts, clauses.size() / 3 + 1000);
+
+    tribool result = tribool::undef;
+    for(uint64_t restarts = 0; result == tribool::undef; ++restarts) {
+      uint64_t budget = static_cast<uint64_t>(luby(2, restarts) * 100);
+      result = search(budget, assumptions);
+    }
+
+    if(result == true) {
+      model.resize(nvars + 1, 0);
+      for(uint32_t v = 1; v <= nvars; ++v)
+        model[v] = values[mklit(v, true)];
+    }
+    cancel(0);
+
+    return result == true;
+  }
+
+  cdcl::cdcl() : _data{std::make_unique<_cdcl_t>()} { }
+
+  cdcl::~cdcl() = default;
+
+  void cdcl::new_vars(size_t n) {
+    _data->new_vars(n);
+  }
+
+  size_t cdcl::nvars() const {
+    return _data->nvars;
+  }
+
+  void cdcl::assert_clause(dimacs::clause const& cl) {
+    std::vector<lit_t> &lits = _data->lits;
+    lits.clear();
+    for(dimacs::literal lit : cl.literals) {
+      black_assert(lit.var > 0 && lit.var <= _data->nvars);
+      lits.push_back(mklit(lit.var, lit.sign));
+    }
+
+    _data->model.clear();
+    _data->add_clause(lits);
+  }
+
+  bool cdcl::is_sat() {
+    return _data->solve({});
+  }
+
+  bool cdcl::is_sat_with(std::vector<dimacs::literal> const& assumptions) {
+    std::vector<lit_t> lits;
+    for(dimacs::literal lit : assumptions) {
+      black_assert(lit.var > 0 && lit.var <= _data->nvars);
+      lits.push_back(mklit(lit.var, lit.sign));
+    }
+
+    return _data->solve(lits);
+  }
+
+  tribool cdcl::value(uint32_t v) const {
+    if(v >= _data->model.size() || _data->model[v] == 0)
+      return tribool::undef;
+
+    return _data->model[v] > 0;
+  }
+
+  void cdcl::clear() {
+    this->clear_vars();
+    _data = std::make_unique<_cdcl_t>();
+  }
+
+  // the solver is part of BLACK, so there is no third-party license
+  std::optional<std::string> cdcl::license() const {
+    return std::nullopt;
+  }
+}
@@ -28,6 +28,8 @@
 
 #include <tsl/hopscotch_map.h>
 
+#include <limits>
+
 BLACK_REGISTER_SAT_BACKEND(cmsat)
 
 namespace black::sat::backends
@@ -35,9 +37,16 @@ namespace black::sat::backends
   struct cmsat::_cmsat_t {
     std::unique_ptr<CMSat::SATSolver> solver;
     bool model_available = false;
+    std::vector<CMSat::Lit> lits;
+    unsigned threads = 1; // kept across calls to clear()
+    bool empty = true;    // no variable or clause added yet
 
-    _cmsat_t() {
+    // CryptoMiniSat requires the number of threads to be set before
+    // creating any variable
+    _cmsat_t(unsigned _threads = 1) : threads{_threads} {
       solver = std::make_unique<CMSat::SATSolver>();
+      if(threads > 1)
+        solver->set_num_threads(threads);
       solver->new_var();
     }
   };
@@ -47,6 +56,7 @@ namespace black::sat::backends
   cmsat::~cmsat() = default;
 
   void cmsat::new_vars(size_t n) {
+    _data->empty = false;
     _data->solver->new_vars(n);
   }
   
@@ -54,8 +64,10 @@ namespace black::sat::backends
     return _data->solver->nVars();
   }
 
-  void cmsat::assert_clause(dimacs::clause cl) {
-    std::vector<CMSat::Lit> lits;
+  void cmsat::assert_clause(dimacs::clause const& cl) {
+    _data->empty = false;
+    std::vector<CMSat::Lit> &lits = _data->lits;
+    lits.clear();
     for(dimacs::literal lit : cl.literals) {
       lits.push_back(CMSat::Lit{lit.var, !lit.sign});
     }
@@ -97,9 +109,26 @@ namespace black::sat::backends
       model[v] == CMSat::l_False ? tribool{false} : tribool::undef;
   }
 
+  bool cmsat::set_option(std::string_view name, option_value const& v) {
+    int64_t const *n = std::get_if<int64_t>(&v);
+    if(name != "threads" || !n || *n <= 0 || 
+       *n > std::numeric_limits<unsigned>::max())
+      return false;
+
+    // the number of threads cannot be changed once the solver has been
+    // used, since the solver has to be created anew
+    if(!_data->empty)
+      return false;
+
+    this->clear_vars();
+    _data = std::make_unique<_cmsat_t>(static_cast<unsigned>(*n));
+
+    return true;
+  }
+
   void cmsat::clear() {
     this->clear_vars();
-    _data = std::make_unique<_cmsat_t>();
+    _data = std::make_unique<_cmsat_t>(_data->threads);
   }
 
   std::optional<std::string> cmsat::license() const
@@ -0,0 +1,189 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <black/sat/backends/ipasir.hpp>
+
+#include <dlfcn.h>
+
+#include <limits>
+#include <type_traits>
+
+namespace black::sat::backends
+{
+  namespace {
+    // the entry points of the IPASIR interface used by the backend
+    struct ipasir_api {
+      void *handle = nullptr;
+      const char *(*signature)() = nullptr;
+      void *(*init)() = nullptr;
+      void (*release)(void *) = nullptr;
+      void (*add)(void *, int32_t) = nullptr;
+      void (*assume)(void *, int32_t) = nullptr;
+      int (*solve)(void *) = nullptr;
+      int32_t (*val)(void *, int32_t) = nullptr;
+    };
+
+    // loads the given library and looks up the IPASIR entry points
+    std::optional<std::string> 
+    load(std::string const& library, ipasir_api &api) {
+      api.handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+      if(!api.handle)
+        return std::string{dlerror()};
+
+      std::optional<std::string> error;
+      auto lookup = [&](char const *name, auto &fptr) {
+        using fptr_t = std::remove_reference_t<decltype(fptr)>;
+        if(error)
+          return;
+        
+        fptr = reinterpret_cast<fptr_t>(dlsym(api.handle, name));
+        if(!fptr)
+          error = "'" + library + "' does not export '" + name + "'";
+      };
+
+      lookup("ipasir_signature", api.signature);
+      lookup("ipasir_init", api.init);
+      lookup("ipasir_release", api.release);
+      lookup("ipasir_add", api.add);
+      lookup("ipasir_assume", api.assume);
+      lookup("ipasir_solve", api.solve);
+      lookup("ipasir_val", api.val);
+
+      if(error) {
+        dlclose(api.handle);
+        api.handle = nullptr;
+      }
+      
+      return error;
+    }
+  }
+
+  struct ipasir::_ipasir_t {
+    ipasir_api api;
+    void *solver = nullptr;
+    size_t nvars = 0;
+    bool model_available = false;
+
+    _ipasir_t(std::string const& library) {
+      [[maybe_unused]] std::optional<std::string> error = load(library, api);
+      black_assert(!error);
+
+      solver = api.init();
+    }
+
+    ~_ipasir_t() {
+      api.release(solver);
+      dlclose(api.handle);
+    }
+  };
+
+  ipasir::ipasir(std::string const& library) 
+    : _data{std::make_unique<_ipasir_t>(library)} { }
+
+  ipasir::~ipasir() = default;
+
+  std::optional<std::string> 
+  ipasir::register_backend(std::string name, std::string const& library) {
+    ipasir_api api;
+    if(auto error = load(library, api); error)
+      return error;
+    
+    // the library is kept loaded, so instantiating the backend is cheap
+    std::string error = "SAT backend '" + name + "' already exists";
+    bool registered = solver::register_backend(std::move(name), 
+      [library]() -> std::unique_ptr<sat::solver> {
+        return std::make_unique<ipasir>(library);
+      }
+    );
+    
+    if(!registered) {
+      dlclose(api.handle);
+      return error;
+    }
+
+    return {};
+  }
+
+  std::string ipasir::signature() const {
+    return _data->api.signature();
+  }
+
+  void ipasir::new_vars(size_t n) {
+    // IPASIR variables are implicitly declared when first used
+    _data->nvars += n;
+    black_assert(_data->nvars <= std::numeric_limits<int32_t>::max());
+  }
+
+  size_t ipasir::nvars() const {
+    return _data->nvars;
+  }
+
+  void ipasir::assert_clause(dimacs::clause const& cl) {
+    _data->model_available = false;
+    for(dimacs::literal lit : cl.literals) {
+      int32_t v = static_cast<int32_t>(lit.var);
+      _data->api.add(_data->solver, lit.sign ? v : -v);
+    }
+    _data->api.add(_data->solver, 0);
+  }
+
+  bool ipasir::is_sat() {
+    // 10 means SAT, 20 means UNSAT
+    bool result = _data->api.solve(_data->solver) == 10;
+    _data->model_available = result;
+
+    return result;
+  }
+
+  bool ipasir::is_sat_with(std::vector<dimacs::literal> const& assumptions) {
+    // assumptions only hold for the next call to ipasir_solve()
+    for(dimacs::literal lit : assumptions) {
+      int32_t v = static_cast<int32_t>(lit.var);
+      _data->api.assume(_data->solver, lit.sign ? v : -v);
+    }
+
+    return is_sat();
+  }
+
+  tribool ipasir::value(uint32_t v) const {
+    if(!_data->model_available || v == 0 || v > _data->nvars)
+      return tribool::undef;
+
+    int32_t val = _data->api.val(_data->solver, static_cast<int32_t>(v));
+    
+    return val > 0 ? tribool{true} : val < 0 ? tribool{false} : tribool::undef;
+  }
+
+  void ipasir::clear() {
+    this->clear_vars();
+    _data->api.release(_data->solver);
+    _data->solver = _data->api.init();
+    _data->nvars = 0;
+    _data->model_available = false;
+  }
+
+  // the license of the loaded solver is not known
+  std::optional<std::string> ipasir::license() const {
+    return std::nullopt;
+  }
+}
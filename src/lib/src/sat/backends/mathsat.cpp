@@ -32,8 +32,10 @@
 #include <mathsat.h>
 #include <fmt/format.h>
 #include <tsl/hopscotch_map.h>
+#include <tsl/hopscotch_set.h>
 
 #include <string>
+#include <charconv>
 
 BLACK_REGISTER_SAT_BACKEND(mathsat)
 
@@ -42,8 +44,15 @@ namespace black::sat::backends
   struct mathsat::_mathsat_t {
     msat_env env;
     tsl::hopscotch_map<formula, msat_term> terms;
+
+    // atoms are named by integers, numbered in order of creation
+    uint64_t next_symbol = 0;
     std::optional<msat_model> model;
 
+    // assumptions whose guard has already been asserted
+    tsl::hopscotch_set<formula> guarded;
+
+    void update_model(msat_result res);
     msat_term to_mathsat(formula);
     msat_term to_mathsat_inner(formula);
 
@@ -71,36 +80,41 @@ namespace black::sat::backends
   bool mathsat::is_sat() { 
     msat_result res = msat_solve(_data->env);
 
-    if(res == MSAT_SAT) {
-      if(_data->model)
-        msat_destroy_model(*_data->model);
-
-      _data->model = msat_get_model(_data->env);
-      black_assert(!MSAT_ERROR_MODEL(*_data->model));
-    }
+    _data->update_model(res);
 
     return (res == MSAT_SAT);
   }
 
+  //
+  // As in the z3 backend, the assumption is guarded by a fresh atom
+  // asserted at the base level, instead of being asserted in a new
+  // backtracking point, so that learned clauses are kept across calls.
+  //
   bool mathsat::is_sat_with(formula f) 
   {
-    msat_push_backtrack_point(_data->env);
-  
-    assert_formula(f);
-    msat_result res = msat_solve(_data->env);
+    atom guard = f.sigma()->var(f);
+    if(_data->guarded.insert(f).second)
+      assert_formula(implies(guard, f));
 
-    if(res == MSAT_SAT) {
-      if(_data->model)
-        msat_destroy_model(*_data->model);
+    msat_term term = _data->to_mathsat(guard);
+    msat_result res = msat_solve_with_assumptions(_data->env, &term, 1);
+
+    _data->update_model(res);
 
-      _data->model = msat_get_model(_data->env);
-      black_assert(!MSAT_ERROR_MODEL(*_data->model));
-    }
-  
-    msat_pop_backtrack_point(_data->env);
     return (res == MSAT_SAT);
   }
 
+  void mathsat::_mathsat_t::update_model(msat_result res) {
+    if(res != MSAT_SAT)
+      return;
+
+    if(model)
+      msat_destroy_model(*model);
+
+    model = msat_get_model(env);
+    black_assert(!MSAT_ERROR_MODEL(*model));
+  }
+
   tribool mathsat::value(atom a) const {
     auto it = _data->terms.find(a);
     if(it == _data->terms.end())
@@ -121,6 +135,7 @@ namespace black::sat::backends
 
   void mathsat::clear() {
     msat_reset_env(_data->env);
+    _data->guarded.clear();
   }
 
   msat_term mathsat::_mathsat_t::to_mathsat(formula f) 
@@ -141,10 +156,17 @@ namespace black::sat::backends
         return b.value() ? 
           msat_make_true(env) : msat_make_false(env);
       },
-      [this](atom a) {
+      [this](atom) {
+        // MathSAT has no numeric symbols, so we write the number directly 
+        // into a small buffer, avoiding any allocation
+        char name[24] = {'v'};
+        auto [end, ec] = 
+          std::to_chars(name + 1, name + sizeof(name) - 1, next_symbol++);
+        black_assert(ec == std::errc{});
+        *end = '\0';
+
         msat_decl msat_atom =
-          msat_declare_function(env, to_string(a.unique_id()).c_str(),
-          msat_get_bool_type(env));
+          msat_declare_function(env, name, msat_get_bool_type(env));
 
         return msat_make_constant(env, msat_atom);
       },
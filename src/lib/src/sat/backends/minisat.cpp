@@ -27,22 +27,51 @@
 #include <minisat/simp/SimpSolver.h>
 #include <tsl/hopscotch_map.h>
 
+#include <limits>
+
 BLACK_REGISTER_SAT_BACKEND(minisat)
 
 namespace black::sat::backends
 {
 
+  namespace {
+    // settings of the backend kept across calls to clear()
+    struct settings {
+      // variable elimination is only safe if the user freezes the variables
+      // used across solve calls, so it is disabled until requested
+      bool elim = false;
+      std::optional<int64_t> seed;
+    };
+  }
+
   struct minisat::_minisat_t {
     std::unique_ptr<Minisat::SimpSolver> solver;
     size_t nvars;
     bool model_available = false;
+    Minisat::vec<Minisat::Lit> lits;
+    settings config;
 
-    _minisat_t() {
+    _minisat_t(settings c = {}) : config{c} {
       solver = std::make_unique<Minisat::SimpSolver>();
       solver->verbosity = -1;
-      solver->use_elim = false;
+      solver->use_elim = config.elim;
+      if(config.seed)
+        set_seed(*config.seed);
       solver->newVar();
     }
+
+    // the seed only matters if some decisions are random, so a small
+    // fraction of them is made so (as with MiniSat's `-rnd-freq=0.02`)
+    void set_seed(int64_t seed) {
+      config.seed = seed;
+      solver->random_seed = static_cast<double>(seed);
+      solver->random_var_freq = 0.02;
+    }
+
+    Minisat::Lit lit(dimacs::literal l) const {
+      black_assert(!solver->isEliminated(Minisat::Var(l.var)));
+      return Minisat::mkLit(Minisat::Var(l.var), !l.sign);
+    }
   };
 
   minisat::minisat() : _data{std::make_unique<_minisat_t>()} { }
@@ -60,11 +89,11 @@ namespace black::sat::backends
     return _data->nvars;
   }
 
-  void minisat::assert_clause(dimacs::clause cl) { 
-    Minisat::vec<Minisat::Lit> lits;
-    for(dimacs::literal lit : cl.literals) {
-      lits.push(Minisat::mkLit(lit.var, !lit.sign));
-    }
+  void minisat::assert_clause(dimacs::clause const& cl) { 
+    Minisat::vec<Minisat::Lit> &lits = _data->lits;
+    lits.clear();
+    for(dimacs::literal lit : cl.literals)
+      lits.push(_data->lit(lit));
 
     _data->solver->addClause(lits);
   }
@@ -78,9 +107,8 @@ namespace black::sat::backends
 
   bool minisat::is_sat_with(std::vector<dimacs::literal> const& assumptions) {
     Minisat::vec<Minisat::Lit> lits;
-    for(dimacs::literal lit : assumptions) {
-      lits.push(Minisat::mkLit(lit.var, !lit.sign));
-    }
+    for(dimacs::literal lit : assumptions)
+      lits.push(_data->lit(lit));
 
     bool result = _data->solver->solve(lits);
     _data->model_available = result;
@@ -100,9 +128,31 @@ namespace black::sat::backends
         tribool::undef;
   }
 
+  bool minisat::set_option(std::string_view name, option_value const& v) {
+    int64_t const *n = std::get_if<int64_t>(&v);
+    
+    // MiniSat's seeds must be positive
+    if(name != "seed" || !n || *n <= 0 || 
+       *n >= std::numeric_limits<int32_t>::max())
+      return false;
+
+    _data->set_seed(*n);
+    
+    return true;
+  }
+
+  void minisat::enable_elimination() {
+    _data->config.elim = true;
+    _data->solver->use_elim = true;
+  }
+
+  void minisat::freeze(uint32_t v) {
+    _data->solver->setFrozen(Minisat::Var(v), true);
+  }
+
   void minisat::clear() {
     this->clear_vars();
-    _data = std::make_unique<_minisat_t>();
+    _data = std::make_unique<_minisat_t>(_data->config);
   }
 
   std::optional<std::string> minisat::license() const
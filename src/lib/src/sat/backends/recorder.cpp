@@ -0,0 +1,250 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <black/sat/backends/recorder.hpp>
+#include <black/logic/alphabet.hpp>
+
+#include <fmt/format.h>
+
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace black::sat::backends
+{
+  // the output is written to the file in chunks of this size
+  static constexpr size_t flush_threshold = 1 << 20;
+
+  // sessions recorded so far at a path, and the first error raised, if any
+  struct sessions_t {
+    size_t count = 0;
+    std::optional<std::string> error;
+  };
+
+  static std::mutex _sessions_mutex;
+  static std::map<std::string, sessions_t> _sessions;
+
+  // path of the file for the next session recorded at `path`
+  static std::string session_path(std::string const& path) {
+    std::lock_guard<std::mutex> lock{_sessions_mutex};
+    size_t n = _sessions[path].count++;
+
+    return n == 0 ? path : fmt::format("{}.{}", path, n);
+  }
+
+  // records an error for the sessions at `path`, unless one is already there
+  static void session_error(std::string const& path, std::string error) {
+    std::lock_guard<std::mutex> lock{_sessions_mutex};
+    std::optional<std::string> &slot = _sessions[path].error;
+    if(!slot)
+      slot = std::move(error);
+  }
+
+  struct recorder::_recorder_t {
+    std::string path;
+    std::string file; // the file of the current session
+    std::ofstream out;
+    std::string buffer;
+
+    std::unique_ptr<sat::solver> backend;
+
+    // set if the backend has a DIMACS interface, otherwise the clauses are
+    // asserted as formulas over the atoms of `sigma`
+    dimacs::solver *dimacs = nullptr;
+    alphabet sigma;
+    size_t nvars = 0;
+
+    _recorder_t(std::string const& name, std::string _path)
+      : path{std::move(_path)}, backend{sat::solver::get_solver(name)}
+    {
+      black_assert(backend);
+      dimacs = dynamic_cast<dimacs::solver *>(backend.get());
+      buffer.reserve(flush_threshold);
+      open();
+    }
+
+    ~_recorder_t() { flush(); }
+
+    // failures are recorded for recorder::error() and the session is not 
+    // written, but the calls are still forwarded to the backend
+    void open() {
+      file = session_path(path);
+      out.open(file, std::ios::out | std::ios::trunc);
+      if(!out.is_open())
+        session_error(path, "unable to open file '" + file + "'");
+      buffer += "p inccnf\n";
+    }
+
+    void flush() {
+      if(out.is_open()) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.flush();
+        if(!out) {
+          session_error(path, "unable to write to file '" + file + "'");
+          out.close();
+        }
+      }
+      buffer.clear();
+    }
+
+    void write(std::vector<dimacs::literal> const& lits) {
+      for(dimacs::literal l : lits) {
+        if(!l.sign)
+          buffer += '-';
+        fmt::format_int v{l.var};
+        buffer.append(v.data(), v.size());
+        buffer += ' ';
+      }
+      buffer += "0\n";
+
+      if(buffer.size() >= flush_threshold)
+        flush();
+    }
+
+    formula to_formula(dimacs::literal l) {
+      atom a = sigma.var(l.var);
+      return l.sign ? formula{a} : formula{!a};
+    }
+  };
+
+  recorder::recorder(std::string const& backend, std::string path)
+    : _data{std::make_unique<_recorder_t>(backend, std::move(path))} { }
+
+  recorder::~recorder() = default;
+
+  std::optional<std::string> recorder::register_backend(
+    std::string name, std::string backend, std::string path
+  ) {
+    if(!solver::backend_exists(backend)) {
+      if(auto error = solver::backend_error(backend); error)
+        return "unable to load SAT backend '" + backend + "': " + *error;
+      return "unknown SAT backend '" + backend + "'";
+    }
+
+    if(!std::ofstream{path})
+      return "unable to open file '" + path + "'";
+
+    bool registered = solver::register_backend(name,
+      [backend, path]() -> std::unique_ptr<sat::solver> {
+        return std::make_unique<recorder>(backend, path);
+      }
+    );
+
+    if(!registered)
+      return "SAT backend '" + name + "' already exists";
+
+    return std::nullopt;
+  }
+
+  std::optional<std::string> recorder::error(std::string const& path) {
+    std::lock_guard<std::mutex> lock{_sessions_mutex};
+    if(auto it = _sessions.find(path); it != _sessions.end())
+      return it->second.error;
+
+    return std::nullopt;
+  }
+
+  void recorder::new_vars(size_t n) {
+    _data->nvars += n;
+    if(_data->dimacs)
+      _data->dimacs->new_vars(n);
+  }
+
+  size_t recorder::nvars() const {
+    return _data->nvars;
+  }
+
+  void recorder::assert_clause(dimacs::clause const& cl) {
+    _data->write(cl.literals);
+
+    if(_data->dimacs)
+      return _data->dimacs->assert_clause(cl);
+
+    _data->backend->assert_formula(
+      big_or(_data->sigma, cl.literals, [&](dimacs::literal l) {
+        return _data->to_formula(l);
+      })
+    );
+  }
+
+  bool recorder::is_sat() {
+    return is_sat_with(std::vector<dimacs::literal>{});
+  }
+
+  bool recorder::is_sat_with(std::vector<dimacs::literal> const& assumptions)
+  {
+    // the file is flushed before each solve call, so that it is complete
+    // even if the solver never returns
+    _data->buffer += "a ";
+    _data->write(assumptions);
+    _data->flush();
+
+    if(_data->dimacs)
+      return assumptions.empty() ? _data->dimacs->is_sat()
+                                 : _data->dimacs->is_sat_with(assumptions);
+
+    if(assumptions.empty())
+      return _data->backend->is_sat();
+
+    return _data->backend->is_sat_with(
+      big_and(_data->sigma, assumptions, [&](dimacs::literal l) {
+        return _data->to_formula(l);
+      })
+    );
+  }
+
+  tribool recorder::value(uint32_t v) const {
+    if(_data->dimacs)
+      return _data->dimacs->value(v);
+
+    return _data->backend->value(_data->sigma.var(v));
+  }
+
+  bool recorder::set_option(std::string_view name, option_value const& v) {
+    return _data->backend->set_option(name, v);
+  }
+
+  void recorder::enable_elimination() {
+    if(_data->dimacs)
+      _data->dimacs->enable_elimination();
+  }
+
+  void recorder::freeze(uint32_t v) {
+    if(_data->dimacs)
+      _data->dimacs->freeze(v);
+  }
+
+  void recorder::clear() {
+    this->clear_vars();
+    _data->backend->clear();
+    _data->nvars = 0;
+
+    _data->flush();
+    _data->out.close();
+    _data->open();
+  }
+
+  std::optional<std::string> recorder::license() const {
+    return _data->backend->license();
+  }
+}
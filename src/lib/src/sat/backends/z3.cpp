@@ -27,8 +27,10 @@
 
 #include <z3.h>
 #include <tsl/hopscotch_map.h>
+#include <tsl/hopscotch_set.h>
 
 #include <limits>
+#include <map>
 
 BLACK_REGISTER_SAT_BACKEND(z3)
 
@@ -45,6 +47,14 @@ namespace black::sat::backends
 
     tsl::hopscotch_map<formula, Z3_ast> terms;
 
+    // atoms are named by integer symbols, numbered in order of creation
+    int next_symbol = 0;
+
+    // assumptions whose guard has already been asserted
+    tsl::hopscotch_set<formula> guarded;
+
+    void update_model(Z3_lbool res);
+
     Z3_ast to_z3(formula);
     Z3_ast to_z3_inner(formula);
   };
@@ -115,42 +125,43 @@ namespace black::sat::backends
     Z3_solver_assert(_data->context, _data->solver, _data->to_z3(f));
   }
   
+  //
+  // The assumption is guarded by a fresh atom, with the guard asserted at
+  // the base level and only the atom passed to the solver as an assumption.
+  // No backtracking point is created, so what the solver learns is kept
+  // across calls.
+  //
   bool z3::is_sat_with(formula f) {
-    Z3_solver_push(_data->context, _data->solver);
-    assert_formula(iff(fresh(f), f));
+    if(_data->guarded.insert(f).second)
+      assert_formula(implies(fresh(f), f));
+
     Z3_ast term = _data->to_z3(fresh(f));
     
     Z3_lbool res = 
       Z3_solver_check_assumptions(_data->context, _data->solver, 1, &term);
 
-    bool result = (res == Z3_L_TRUE);
-
-    if(result) {
-      if(_data->model)
-        Z3_model_dec_ref(_data->context, *_data->model);
-      
-      _data->model = Z3_solver_get_model(_data->context, _data->solver);
-    }
+    _data->update_model(res);
 
-    Z3_solver_pop(_data->context, _data->solver, 1);
-
-    return result;
+    return (res == Z3_L_TRUE);
   }
 
   bool z3::is_sat() { 
     Z3_lbool res = Z3_solver_check(_data->context, _data->solver);
 
-    bool result = (res == Z3_L_TRUE);
+    _data->update_model(res);
 
-    if(result) {
-      if(_data->model)
-        Z3_model_dec_ref(_data->context, *_data->model);
-      
-      _data->model = Z3_solver_get_model(_data->context, _data->solver);
-      Z3_model_inc_ref(_data->context, *_data->model);
-    }
+    return (res == Z3_L_TRUE);
+  }
 
-    return result;
+  void z3::_z3_t::update_model(Z3_lbool res) {
+    if(res != Z3_L_TRUE)
+      return;
+
+    if(model)
+      Z3_model_dec_ref(context, *model);
+    
+    model = Z3_solver_get_model(context, solver);
+    Z3_model_inc_ref(context, *model);
   }
 
   tribool z3::value(atom a) const {
@@ -178,8 +189,38 @@ namespace black::sat::backends
     return result;
   }
 
+  bool z3::set_option(std::string_view name, option_value const& v) {
+    // names of the corresponding parameters of Z3
+    static const std::map<std::string_view, char const *> params = {
+      {"threads", "threads"},
+      {"seed", "random_seed"},
+      {"memory", "max_memory"}
+    };
+
+    auto it = params.find(name);
+    int64_t const *n = std::get_if<int64_t>(&v);
+    if(it == params.end() || !n || *n < 0 || 
+       *n > std::numeric_limits<unsigned>::max())
+      return false;
+
+    if(name == "threads" && *n == 0)
+      return false;
+
+    Z3_params p = Z3_mk_params(_data->context);
+    Z3_params_inc_ref(_data->context, p);
+    Z3_params_set_uint(
+      _data->context, p, Z3_mk_string_symbol(_data->context, it->second), 
+      static_cast<unsigned>(*n)
+    );
+    Z3_solver_set_params(_data->context, _data->solver, p);
+    Z3_params_dec_ref(_data->context, p);
+
+    return true;
+  }
+
   void z3::clear() { 
     Z3_solver_reset(_data->context, _data->solver);
+    _data->guarded.clear();
   }
 
   // TODO: Factor out common logic with mathsat.cpp
@@ -200,10 +241,11 @@ namespace black::sat::backends
       [this](boolean b) {
         return b.value() ? Z3_mk_true(context) : Z3_mk_false(context);
       },
-      [this](atom a) {
+      [this](atom) {
+        black_assert(next_symbol < std::numeric_limits<int>::max());
+
         Z3_sort sort = Z3_mk_bool_sort(context);
-        Z3_symbol symbol = 
-          Z3_mk_string_symbol(context, to_string(a.unique_id()).c_str());
+        Z3_symbol symbol = Z3_mk_int_symbol(context, next_symbol++);
         
         return Z3_mk_const(context, symbol, sort);
       },
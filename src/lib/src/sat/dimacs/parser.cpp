@@ -24,151 +24,298 @@
 #include <black/sat/dimacs.hpp>
 #include <black/support/config.hpp>
 
-#include <cctype>
+#include <cstring>
 #include <cmath>
 #include <fmt/format.h>
 
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+#if __has_include(<sys/mman.h>)
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #define BLACK_DIMACS_MMAP
+#endif
+
 namespace black::sat::dimacs::internal 
 {  
+  //
+  // The parser works on a buffer holding the whole input, scanning the 
+  // integers by hand, and fills the flat clause store of the problem
+  //
   struct _parser_t {
-    std::istream &in;
+    char const *p;
+    char const *end;
     std::function<void(std::string)> handler;
 
-    _parser_t(std::istream &_in, std::function<void(std::string)> _handler)
-       : in{_in}, handler{_handler} { }
+    _parser_t(
+      char const *_begin, char const *_end, 
+      std::function<void(std::string)> _handler
+    ) : p{_begin}, end{_end}, handler{_handler} { }
+
+    static bool is_space(char c) {
+      return c == ' ' || c == '\n' || c == '\t' || c == '\r' || 
+             c == '\v' || c == '\f';
+    }
 
-    void skip_comment();
     void skip();
-    bool parse_header();
-    std::optional<literal> parse_literal();
-    std::vector<clause> parse_clauses();
+    bool parse_keyword(char const *keyword);
+    bool parse_int(int64_t &v);
+    bool parse_header(problem &result);
+    void parse_clauses(problem &result);
+    bool parse_query(problem &result);
     std::optional<problem> parse();
   };
 
-  void _parser_t::skip_comment() {
-    if(in.peek() != 'c')
-      return;
+  void _parser_t::skip() {
+    while(p < end) {
+      if(is_space(*p))
+        ++p;
+      else if(*p == 'c') {
+        auto eol = static_cast<char const *>(
+          std::memchr(p, '\n', static_cast<size_t>(end - p))
+        );
+        p = eol ? eol : end;
+      } else
+        break;
+    }
+  }
+
+  bool _parser_t::parse_keyword(char const *keyword) {
+    size_t n = std::strlen(keyword);
+    if(static_cast<size_t>(end - p) < n || std::memcmp(p, keyword, n) != 0)
+      return false;
     
-    while(in.good() && in.peek() != '\n')
-      in.get();
+    p += n;
+    return true;
   }
 
-  void _parser_t::skip() {
-    while(in.good() && (isspace(in.peek()) || in.peek() == 'c')) {
-      skip_comment();
-      in.get();
+  bool _parser_t::parse_int(int64_t &v) {
+    while(p < end && is_space(*p))
+      ++p;
+
+    bool negative = p < end && *p == '-';
+    if(negative)
+      ++p;
+
+    if(p == end || *p < '0' || *p > '9')
+      return false;
+
+    uint64_t value = 0;
+    while(p < end && *p >= '0' && *p <= '9') {
+      value = value * 10 + static_cast<uint64_t>(*p - '0');
+      if(value > std::numeric_limits<uint32_t>::max())
+        return false;
+      ++p;
     }
+
+    v = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    return true;
   }
 
-  bool _parser_t::parse_header() {
-    if(!in.good())
-      return false;
+  bool _parser_t::parse_header(problem &result) {
+    // incremental problems have no declared sizes
+    if(parse_keyword("p inccnf")) {
+      result.incremental = true;
+      return true;
+    }
 
-    std::string h;
-    for(int i = 0; i < 5; ++i)
-      h += (char)in.get();
-    
-    if(h != "p cnf") {
+    if(!parse_keyword("p cnf")) {
       handler("expected problem header");
       return false;
     }
 
-    uint32_t nvars = 0;
-    uint64_t nclauses = 0;
-
-    in >> nvars; // we ignore nvars and nclauses, but they must be there
-    in >> nclauses;
-    
-    if(in.fail()) {
+    // we ignore nvars and nclauses, but they must be there
+    int64_t nvars = 0, nclauses = 0;
+    if(!parse_int(nvars) || !parse_int(nclauses) || nvars < 0 || nclauses < 0)
+    {
       handler("expected nbvars and nbclauses in problem header");
       return false;
     }
 
+    // the declared number of clauses is only trusted as far as the size of 
+    // the input allows
+    size_t max_clauses = static_cast<size_t>(end - p) / 2;
+    result.ends.reserve(std::min(static_cast<size_t>(nclauses), max_clauses));
+
     return true;
   }
 
-  std::optional<literal> _parser_t::parse_literal() 
+  void _parser_t::parse_clauses(problem &result) 
   {
-    if(in.eof())
-      return std::nullopt;
-      
-    int32_t v = 0;
-    if(!(in >> v)) {
-      handler("expected literal");
-      return std::nullopt;
-    }
+    bool unterminated = false; // whether the last clause misses the '0'
+    while(true) {
+      skip();
+      if(p == end) {
+        if(unterminated)
+          handler("expected '0' at the end of clause");
+        return;
+      }
 
-    return literal{ // LCOV_EXCL_LINE
-      /*sign=*/ (v >= 0), 
-      /*var=*/  static_cast<uint32_t>(abs(v))
-    };
+      // solve calls of incremental problems, until the next '0'
+      if(*p == 'a' && result.incremental) {
+        ++p;
+        if(!parse_query(result))
+          return;
+        continue;
+      }
+
+      int64_t v = 0;
+      if(!parse_int(v) || v < -std::numeric_limits<int32_t>::max() || 
+         v > std::numeric_limits<int32_t>::max()) {
+        handler("expected literal");
+        return;
+      }
+
+      if(v == 0) {
+        result.ends.push_back(result.literals.size());
+        unterminated = false;
+        continue;
+      }
+
+      uint32_t var = static_cast<uint32_t>(v < 0 ? -v : v);
+      result.literals.push_back(literal{/*sign=*/ v > 0, var});
+      result.nvars = std::max(result.nvars, var);
+      unterminated = true;
+    }
   }
 
-  std::vector<clause> _parser_t::parse_clauses() 
+  bool _parser_t::parse_query(problem &result) 
   {
-    std::vector<clause> clauses;
-
-    clause cl;
-    do
-    {
+    query q{result.size(), {}};
+    while(true) {
       skip();
-      std::optional<literal> l = parse_literal();
-      if(!l) {
-        if(cl.literals.size() > 0)
-          handler("expected '0' at the end of clause");
-        return clauses;
+      if(p == end) {
+        handler("expected '0' at the end of assumptions");
+        return false;
       }
-      if(l->var == 0) {
-        clauses.push_back(cl);
-        cl.literals.clear();
-      } else {
-        cl.literals.push_back(*l);
+
+      int64_t v = 0;
+      if(!parse_int(v) || v < -std::numeric_limits<int32_t>::max() || 
+         v > std::numeric_limits<int32_t>::max()) {
+        handler("expected literal");
+        return false;
       }
-    } while (!in.eof());
-    
-    return clauses;
+
+      if(v == 0)
+        break;
+
+      uint32_t var = static_cast<uint32_t>(v < 0 ? -v : v);
+      q.assumptions.push_back(literal{/*sign=*/ v > 0, var});
+      result.nvars = std::max(result.nvars, var);
+    }
+
+    result.queries.push_back(std::move(q));
+    return true;
   }
 
   std::optional<problem> _parser_t::parse() 
   {
+    problem result;
+    
     skip();
-    if(!parse_header())
+    if(!parse_header(result))
       return std::nullopt;
 
-    skip();
-    return problem{parse_clauses()};
+    parse_clauses(result);
+    
+    return result;
   }
 
   std::optional<problem> parse(
-    std::istream &in, std::function<void(std::string)> handler
+    char const *begin, char const *end, 
+    std::function<void(std::string)> handler
   ) {
-    _parser_t parser{in, handler};
+    _parser_t parser{begin, end, handler};
 
     return parser.parse();
   }
 
+  std::optional<problem> parse(
+    std::istream &in, std::function<void(std::string)> handler
+  ) {
+    std::string buffer{
+      std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}
+    };
+
+    return parse(buffer.data(), buffer.data() + buffer.size(), handler);
+  }
+
+  std::optional<problem> parse_file(
+    std::string const& path, std::function<void(std::string)> handler
+  ) {
+  #ifdef BLACK_DIMACS_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0) {
+      if(fd >= 0)
+        close(fd);
+      handler(fmt::format("unable to open file '{}'", path));
+      return std::nullopt;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void *data = size > 0 ? 
+      mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    // fallback for empty files and for those that cannot be mapped
+    if(data == MAP_FAILED) {
+      std::ifstream in{path};
+      return parse(in, handler);
+    }
+
+    madvise(data, size, MADV_SEQUENTIAL);
+    char const *begin = static_cast<char const *>(data);
+    std::optional<problem> result = parse(begin, begin + size, handler);
+    munmap(data, size);
+
+    return result;
+  #else
+    std::ifstream in{path};
+    if(!in) {
+      handler(fmt::format("unable to open file '{}'", path));
+      return std::nullopt;
+    }
+    
+    return parse(in, handler);
+  #endif
+  }
+
   std::string to_string(literal l) {
     return fmt::format("{}{}", l.sign ? "" : "-", l.var);
   }
 
-  // void print(std::ostream &out, problem p) {
-  //   out << fmt::format("c BLACK v{}\n", black::version);
+  void print(std::ostream &out, problem const& p) {
+    out << fmt::format("c BLACK v{}\n", black::version);
 
-  //   size_t nclauses = p.clauses.size();
-  //   uint32_t nvars = 0;
-  //   for(dimacs::clause c : p.clauses)
-  //     for(dimacs::literal l : c.literals)
-  //       nvars = l.var > nvars ? l.var : nvars;
+    if(p.incremental)
+      out << "p inccnf\n";
+    else
+      out << fmt::format("p cnf {} {}\n", p.nvars, p.size());
 
-  //   out << fmt::format("p cnf {} {}\n", nvars, nclauses);
+    auto print_lits = [&](auto begin, auto end) {
+      for(auto it = begin; it != end; ++it)
+        out << to_string(*it) << ' ';
+      out << "0\n";
+    };
 
-  //   for(dimacs::clause c : p.clauses) {
-  //     for(dimacs::literal l : c.literals) {
-  //       out << to_string(l) << ' ';
-  //     }
-  //     out << "0\n";
-  //   }
-  // }
+    size_t next = 0; // next query to print
+    for(size_t i = 0; i <= p.size(); ++i) {
+      for(; next < p.queries.size() && p.queries[next].nclauses == i; ++next) {
+        out << "a ";
+        print_lits(
+          p.queries[next].assumptions.begin(), p.queries[next].assumptions.end()
+        );
+      }
+
+      if(i < p.size())
+        print_lits(p[i].begin(), p[i].end());
+    }
+  }
 
   void print(std::ostream &out, std::optional<solution> const& s) {
     out << fmt::format("c BLACK v{}\n", black::version);
@@ -22,16 +22,23 @@
 // SOFTWARE.
 
 #include <black/sat/dimacs.hpp>
+#include <black/support/range.hpp>
 
 #include <tsl/hopscotch_map.h>
 
 namespace black::sat::dimacs::internal
 {
   struct solver::_solver_t {
-    tsl::hopscotch_map<atom, uint32_t> vars;
+    tsl::hopscotch_map<formula_id, uint32_t> vars;
+    cnf_encoding encoding = cnf_encoding::tseitin;
+
+    // buffers reused across calls to assert_formula()
+    black::cnf cnf;
+    std::vector<uint32_t> mapped;
+    dimacs::clause clause;
 
     // retrieve the var number or add it if the atom is not registered
-    uint32_t var(atom a) {
+    uint32_t var(formula_id a) {
       if(auto it = vars.find(a); it != vars.end())
         return it->second;
 
@@ -52,30 +59,32 @@ namespace black::sat::dimacs::internal
   void solver::assert_formula(formula f) 
   {
     // conversion of the formula to CNF
-    cnf c = to_cnf(f);
+    _data->cnf.clear();
+    to_cnf(f, _data->cnf, _data->encoding);
 
-    // census of new variables
+    // census of new variables, mapping each literal to its var number
     size_t old_size = _data->vars.size();
-    for(black::clause cl : c.clauses) {
-      for(black::literal lit : cl.literals) {
-        _data->var(lit.atom);
-      }
-    }
+    _data->mapped.clear();
+    for(black::literal lit : _data->cnf.literals())
+      _data->mapped.push_back(_data->var(lit.atom_id()));
     
-    // allocate the new variables
+    // allocate the new variables, which may be used again by later calls
     size_t new_size = _data->vars.size();
-    if(new_size > old_size)
+    if(new_size > old_size) {
       this->new_vars(new_size - old_size);
+      for(size_t v = old_size + 1; v <= new_size; ++v)
+        this->freeze(static_cast<uint32_t>(v));
+    }
 
     // assert the clauses
-    for(black::clause cl : c.clauses) {
-      dimacs::clause dcl;
-      for(black::literal lit : cl.literals) {
-        dcl.literals.push_back({ lit.sign, _data->var(lit.atom) });
-      }
-
-      // assert the clause
-      this->assert_clause(dcl);
+    std::vector<black::literal> const& lits = _data->cnf.literals();
+    size_t i = 0;
+    for(black::clause cl : _data->cnf) {
+      _data->clause.literals.clear();
+      for(size_t end = i + cl.size(); i < end; ++i)
+        _data->clause.literals.push_back({ lits[i].sign(), _data->mapped[i] });
+
+      this->assert_clause(_data->clause);
     }
   }
 
@@ -84,13 +93,18 @@ namespace black::sat::dimacs::internal
   { 
     atom fresh = assumption.sigma()->var(assumption);
 
-    this->assert_formula(iff(fresh, assumption));
+    // the assumption is only used positively, so the other direction of the
+    // definition is not needed if the encoding is polarity-aware
+    if(_data->encoding == cnf_encoding::plaisted_greenbaum)
+      this->assert_formula(implies(fresh, assumption));
+    else
+      this->assert_formula(iff(fresh, assumption));
 
-    return this->is_sat_with({{true, _data->var(fresh)}});
+    return this->is_sat_with({{true, _data->var(fresh.unique_id())}});
   }
 
   tribool solver::value(atom a) const {
-    auto it = _data->vars.find(a);
+    auto it = _data->vars.find(a.unique_id());
     if(it == _data->vars.end())
       return tribool::undef;
 
@@ -99,8 +113,23 @@ namespace black::sat::dimacs::internal
     return this->value(var);
   }
 
+  // variable elimination is not supported by default
+  void solver::enable_elimination() { }
+  
+  void solver::freeze(uint32_t) { }
+
+  void solver::set_cnf_encoding(cnf_encoding encoding) {
+    _data->encoding = encoding;
+  }
+
+  cnf_encoding solver::get_cnf_encoding() const {
+    return _data->encoding;
+  }
+
   void solver::clear_vars() {
+    cnf_encoding encoding = _data->encoding;
     _data = std::make_unique<_solver_t>();
+    _data->encoding = encoding;
   }
 
   formula to_formula(alphabet &sigma, dimacs::clause const& c) {
@@ -111,27 +140,63 @@ namespace black::sat::dimacs::internal
   }
 
   formula to_formula(alphabet &sigma, dimacs::problem const& p) {
-    return big_and(sigma, p.clauses, [&](clause c) {
-      return to_formula(sigma, c);
+    return big_and(sigma, black::internal::range(0, p.size()), [&](size_t i) {
+      return big_or(sigma, p[i].begin(), p[i].end(), [&](literal l) {
+        atom a = sigma.var(l.var);
+        return l.sign ? formula{a} : formula{!a};
+      });
     });
   }
 
-  std::optional<solution> solve(dimacs::problem const &p, std::string backend) {
-    alphabet sigma;
+  //
+  // Clause-level backends get the clauses of the problem directly, with
+  // variable numbers unchanged, skipping the conversion to formulas and 
+  // back through the CNF encoding
+  //
+  static bool solve_clauses(dimacs::solver *slv, dimacs::problem const& p) {
+    // all the clauses come before the only solve call, so nothing needs to
+    // be frozen
+    slv->enable_elimination();
+    slv->new_vars(p.nvars);
+
+    dimacs::clause clause;
+    for(size_t i = 0; i < p.size(); ++i) {
+      clause_view cl = p[i];
+      clause.literals.assign(cl.begin(), cl.end());
+      slv->assert_clause(clause);
+    }
+
+    return slv->is_sat();
+  }
 
-    auto solver = sat::solver::get_solver(backend);
+  std::optional<solution> solve(
+    dimacs::problem const &p, std::string backend, sat::options const& opts
+  ) {
+    auto solver = sat::solver::get_solver(backend, opts);
+    black_assert(solver);
+
+    if(auto *slv = dynamic_cast<dimacs::solver *>(solver.get()); slv) {
+      if(!solve_clauses(slv, p))
+        return {};
+
+      solution s;
+      for(uint32_t i = 1; i <= p.nvars; ++i) {
+        tribool v = slv->value(i);
+        if(v != tribool::undef)
+          s.assignments.push_back(literal{(bool)v, i});
+      }
+
+      return s;
+    }
+
+    alphabet sigma;
     solver->assert_formula(to_formula(sigma, p));
 
     if(!solver->is_sat())
       return {};
 
-    uint32_t nvars = 0;
-    for(dimacs::clause c : p.clauses)
-      for(dimacs::literal l : c.literals)
-        nvars = l.var > nvars ? l.var : nvars;
-
     solution s;
-    for(uint32_t i = 1; i <= nvars; ++i) {
+    for(uint32_t i = 1; i <= p.nvars; ++i) {
       atom a = sigma.var(i);
       tribool v = solver->value(a);
       if(v == tribool::undef)
@@ -143,4 +208,48 @@ namespace black::sat::dimacs::internal
     return s;
   }
 
+  std::vector<bool> replay(
+    dimacs::problem const& p, std::string backend, sat::options const& opts
+  ) {
+    auto solver = sat::solver::get_solver(backend, opts);
+    black_assert(solver);
+    auto *slv = dynamic_cast<dimacs::solver *>(solver.get());
+
+    alphabet sigma;
+    auto to_formula = [&](literal l) {
+      atom a = sigma.var(l.var);
+      return l.sign ? formula{a} : formula{!a};
+    };
+
+    if(slv)
+      slv->new_vars(p.nvars);
+
+    std::vector<bool> results;
+    dimacs::clause clause;
+    size_t next = 0; // next clause to assert
+    for(query const& q : p.queries) {
+      for(; next < q.nclauses; ++next) {
+        clause_view cl = p[next];
+        if(slv) {
+          clause.literals.assign(cl.begin(), cl.end());
+          slv->assert_clause(clause);
+        } else
+          solver->assert_formula(
+            big_or(sigma, cl.begin(), cl.end(), to_formula)
+          );
+      }
+
+      if(q.assumptions.empty())
+        results.push_back(solver->is_sat());
+      else if(slv)
+        results.push_back(slv->is_sat_with(q.assumptions));
+      else
+        results.push_back(
+          solver->is_sat_with(big_and(sigma, q.assumptions, to_formula))
+        );
+    }
+
+    return results;
+  }
+
 }
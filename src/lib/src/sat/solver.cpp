@@ -26,16 +26,118 @@
 
 #include <tsl/hopscotch_map.h>
 
-#include <iostream>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+
+#ifdef BLACK_BACKEND_PLUGINS
+  #include <dlfcn.h>
+  #include <filesystem>
+#endif
 
 namespace black::sat
 {
   namespace internal {
     namespace {
       using backends_map = 
-        tsl::hopscotch_map<std::string_view, backend_init_hook::backend_ctor>;
+        tsl::hopscotch_map<std::string_view, solver::backend_ctor>;
       
       std::unique_ptr<backends_map> _backends = nullptr;
+
+      // storage for the names of the backends registered at runtime
+      std::deque<std::string> _runtime_names;
+
+      // guards the registry of backends and the lazy loading of modules
+      std::mutex _loading_mutex;
+
+      // a backend module, with the path of the module, whether it has
+      // been loaded already, and the error raised if loading failed
+      struct plugin_t {
+        std::string path;
+        bool loaded = false;
+        std::optional<std::string> error;
+      };
+
+      // backend modules found at startup, by name. Entries are never
+      // removed, so that the names returned by backends() stay valid
+      using plugins_map = std::map<std::string, plugin_t, std::less<>>;
+      
+      plugins_map discover_plugins();
+
+      plugins_map &plugins() {
+        static plugins_map _plugins = discover_plugins();
+        return _plugins;
+      }
+
+      #ifdef BLACK_BACKEND_PLUGINS
+      //
+      // Backend modules are looked for in the directory of the library
+      // itself, and recognized by their file name
+      //
+      plugins_map discover_plugins() {
+        namespace fs = std::filesystem;
+        
+        plugins_map result;
+        
+        Dl_info info;
+        if(!dladdr(reinterpret_cast<void *>(&discover_plugins), &info))
+          return result; // LCOV_EXCL_LINE
+        
+        std::string_view prefix = BLACK_BACKEND_PLUGIN_PREFIX;
+        std::string_view suffix = BLACK_BACKEND_PLUGIN_SUFFIX;
+
+        std::error_code ec;
+        fs::path dir = fs::path{info.dli_fname}.parent_path();
+        for(auto const& entry : fs::directory_iterator{dir, ec}) {
+          std::string file = entry.path().filename().string();
+          if(
+            file.size() <= prefix.size() + suffix.size() ||
+            file.compare(0, prefix.size(), prefix) != 0 ||
+            file.compare(file.size() - suffix.size(), suffix.size(), suffix)
+          ) continue;
+
+          std::string name = file.substr(
+            prefix.size(), file.size() - prefix.size() - suffix.size()
+          );
+          result.insert({name, plugin_t{entry.path().string(), false, {}}});
+        }
+
+        return result;
+      }
+
+      // loads the module, whose static hook registers the backend. 
+      // Failures are recorded in the entry and the module is not tried again
+      void load_plugin(std::string_view name) {
+        auto it = plugins().find(name);
+        if(it == plugins().end() || it->second.loaded || it->second.error)
+          return;
+
+        if(!dlopen(it->second.path.c_str(), RTLD_NOW | RTLD_LOCAL)) {
+          it->second.error = dlerror();
+          return;
+        }
+        it->second.loaded = true;
+
+        if(!_backends || _backends->find(name) == _backends->end())
+          it->second.error = 
+            "the module '" + it->second.path + "' does not provide it";
+      }
+      #else
+      plugins_map discover_plugins() { return {}; }
+      void load_plugin(std::string_view) { }
+      #endif
+
+      // must be called with `_loading_mutex` held
+      bool registered(std::string_view name) {
+        return _backends && _backends->find(name) != _backends->end();
+      }
+
+      // tells whether the name is taken, even by a module not loaded yet.
+      // Must be called with `_loading_mutex` held
+      bool exists(std::string_view name) {
+        return registered(name) || plugins().find(name) != plugins().end();
+      }
     }
     
     backend_init_hook::backend_init_hook(
@@ -49,29 +151,97 @@ namespace black::sat
     }
   }
 
+  bool solver::register_backend(std::string name, backend_ctor ctor) {
+    using namespace black::sat::internal;
+
+    std::lock_guard<std::mutex> lock{_loading_mutex};
+
+    if(!_backends)
+      _backends = std::make_unique<backends_map>();
+
+    if(exists(name))
+      return false;
+
+    std::string_view key = _runtime_names.emplace_back(std::move(name));
+    _backends->insert({key, std::move(ctor)});
+
+    return true;
+  }
+
+  // the module of the backend, if any, is loaded to tell whether it works
   bool solver::backend_exists(std::string_view name) {
     using namespace black::sat::internal;
     
-    return _backends->find(name) != _backends->end();
+    std::lock_guard<std::mutex> lock{_loading_mutex};
+    if(!registered(name))
+      load_plugin(name);
+
+    return registered(name);
+  }
+
+  std::optional<std::string> solver::backend_error(std::string_view name) {
+    using namespace black::sat::internal;
+
+    std::lock_guard<std::mutex> lock{_loading_mutex};
+    if(auto it = plugins().find(name); it != plugins().end())
+      return it->second.error;
+
+    return {};
   }
 
   std::unique_ptr<solver> solver::get_solver(std::string_view name) 
   {
     using namespace black::sat::internal;
-    auto it = _backends->find(name); 
+
+    backend_ctor ctor;
+    {
+      std::lock_guard<std::mutex> lock{_loading_mutex};
+      
+      if(!registered(name))
+        load_plugin(name);
+
+      if(!registered(name))
+        return nullptr;
+
+      ctor = _backends->find(name)->second;
+    }
     
-    black_assert(it != _backends->end());
+    return ctor();
+  }
+
+  std::unique_ptr<solver> 
+  solver::get_solver(std::string_view name, options const& opts) {
+    std::unique_ptr<solver> result = get_solver(name);
+    if(!result)
+      return nullptr;
+
+    for(auto const& [key, value] : opts)
+      result->set_option(key, value);
     
-    return (it->second)();
+    return result;
+  }
+
+  // no options are supported by default
+  bool solver::set_option(std::string_view, option_value const&) {
+    return false;
   }
 
   std::vector<std::string_view> solver::backends() {
     using namespace black::sat::internal;
 
+    std::lock_guard<std::mutex> lock{_loading_mutex};
+
     std::vector<std::string_view> result;
 
-    for(auto [key,elem] : *_backends) {
-      result.push_back(key);
+    if(_backends)
+      for(auto [key,elem] : *_backends) {
+        result.push_back(key);
+      }
+
+    // modules not loaded yet are listed as well, but not those that failed
+    for(auto const& [key, plugin] : plugins()) {
+      if(!plugin.loaded && !plugin.error)
+        result.push_back(key);
     }
 
     return result;
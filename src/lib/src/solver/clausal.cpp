@@ -0,0 +1,608 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <black/solver/clausal.hpp>
+#include <black/support/range.hpp>
+
+#include <tsl/hopscotch_set.h>
+
+#include <algorithm>
+
+namespace black::internal
+{
+  static clausal_encoder::literal operator!(clausal_encoder::literal l) {
+    return {!l.sign, l.var};
+  }
+
+  clausal_encoder::clausal_encoder(
+    encoder const& enc, sat::dimacs::solver &sat, cnf_encoding encoding
+  ) : _sat{sat}, _finite{enc._finite}, _encoding{encoding}
+  {
+    // the `true` variable of each block
+    _add(_step, {_at({true, 0}, 0)});
+
+    _frm = _index(enc._frm);
+
+    tsl::hopscotch_set<formula> seen;
+    for(unary xreq : enc._xrequests) {
+      if(!seen.insert(xreq).second)
+        continue;
+
+      std::optional<step_literal> ev;
+      if(auto e = encoder::_get_xev(xreq); e)
+        ev = _index(*e);
+
+      _xrequests.push_back({
+        _index(xreq).offset, _index(xreq.operand()), ev,
+        xreq.formula_type() == unary::type::tomorrow
+      });
+    }
+
+    auto add_yz = [&](auto req, std::vector<yzrequest> &reqs) {
+      if(seen.insert(req).second)
+        reqs.push_back({_index(req).offset, _index(req.operand())});
+    };
+
+    for(yesterday y : enc._yrequests)
+      add_yz(y, _yrequests);
+    for(w_yesterday z : enc._zrequests)
+      add_yz(z, _zrequests);
+
+    _build_templates();
+
+    // Later steps refer to the `true` variable, to the requests and to their
+    // operands and eventualities (in the transition, loop and prune 
+    // encodings), so these are frozen. Any other variable of a step is only
+    // used by the clauses asserted together with it.
+    _frozen.push_back(0);
+    for(xrequest const& req : _xrequests) {
+      _frozen.push_back(req.var);
+      if(req.eventuality)
+        _frozen.push_back(req.eventuality->offset);
+    }
+    for(auto const *reqs : {&_yrequests, &_zrequests})
+      for(yzrequest const& req : *reqs) {
+        _frozen.push_back(req.var);
+        _frozen.push_back(req.operand.offset);
+      }
+  }
+
+  //
+  // Indexing of the closure. Ground elements (atoms and X/Y/Z-requests) get a
+  // variable of their own, while the other elements are defined by their
+  // stepped normal form, as in encoder::to_ground_snf().
+  //
+  auto clausal_encoder::_index(formula f) -> step_literal
+  {
+    if(auto it = _closure.find(f); it != _closure.end())
+      return it->second;
+
+    step_literal lit = f.match(
+      [&](boolean b)    { return step_literal{b.value(), 0}; },
+      [&](atom)         { return _ground(f); },
+      [&](tomorrow)     { return _ground(f); },
+      [&](w_tomorrow)   { return _ground(f); },
+      [&](yesterday)    { return _ground(f); },
+      [&](w_yesterday)  { return _ground(f); },
+      [&](negation, formula op) { return !_index(op); },
+      [&](conjunction, formula left, formula right) {
+        return _define_and( _index(left), _index(right));
+      },
+      [&](disjunction, formula left, formula right) {
+        return _define_or( _index(left), _index(right));
+      },
+      [&](implication) -> step_literal { // LCOV_EXCL_LINE
+        black_unreachable(); // LCOV_EXCL_LINE
+      },
+      [&](iff) -> step_literal { // LCOV_EXCL_LINE
+        black_unreachable(); // LCOV_EXCL_LINE
+      },
+      // right || (left && X(u)) == !(!right && (!left || !X(u)))
+      [&](until u, formula left, formula right) {
+        return !_define_and_or(
+          !_index(right), !_index(left), !_index(X(u)));
+      },
+      [&](w_until w, formula left, formula right) {
+        return !_define_and_or(
+          !_index(right), !_index(left), !_index(wX(w)));
+      },
+      [&](eventually e, formula op) {
+        return _define_or( _index(op), _index(X(e)));
+      },
+      [&](always a, formula op) {
+        return _define_and( _index(op), _index(wX(a)));
+      },
+      // (left && right) || (right && wX(r)) == right && (left || wX(r))
+      [&](release r, formula left, formula right) {
+        return _define_and_or(
+          _index(right), _index(left), _index(wX(r)));
+      },
+      [&](s_release r, formula left, formula right) {
+        return _define_and_or(
+          _index(right), _index(left), _index(X(r)));
+      },
+      [&](since s, formula left, formula right) {
+        return !_define_and_or(
+          !_index(right), !_index(left), !_index(Y(s)));
+      },
+      [&](triggered t, formula left, formula right) {
+        return _define_and_or(
+          _index(right), _index(left), _index(Z(t)));
+      },
+      [&](once o, formula op) {
+        return _define_or( _index(op), _index(Y(o)));
+      },
+      [&](historically h, formula op) {
+        return _define_and( _index(op), _index(Z(h)));
+      }
+    );
+
+    _closure.insert({f, lit});
+    return lit;
+  }
+
+  auto clausal_encoder::_ground(formula) -> step_literal {
+    return {true, _block_size++};
+  }
+
+  //
+  // Definitions of the non-ground elements, collected to be added to the 
+  // step template once the polarity of each element is known
+  //
+  auto clausal_encoder::_define_and(step_literal a, step_literal b)
+    -> step_literal
+  {
+    step_literal v = {true, _block_size++};
+    _definitions.push_back({v.offset, a, b, {}});
+
+    return v;
+  }
+
+  auto clausal_encoder::_define_or(step_literal a, step_literal b)
+    -> step_literal
+  {
+    return !_define_and(!a, !b);
+  }
+
+  auto clausal_encoder::_define_and_or(
+    step_literal a, step_literal b, step_literal c
+  ) -> step_literal {
+    step_literal v = {true, _block_size++};
+    _definitions.push_back({v.offset, a, b, c});
+
+    return v;
+  }
+
+  auto clausal_encoder::_at(step_literal l, uint8_t block) 
+    -> template_literal 
+  {
+    return {l.sign, block, l.offset};
+  }
+
+  auto clausal_encoder::_fresh(clause_template &t) -> template_literal {
+    return {true, clause_template::fresh_block, t.fresh++};
+  }
+
+  void clausal_encoder::_add(
+    clause_template &t, std::initializer_list<template_literal> lits
+  ) {
+    t.literals.insert(t.literals.end(), lits);
+    t.ends.push_back(t.literals.size());
+  }
+
+  auto clausal_encoder::_conjoin(
+    clause_template &t, std::vector<template_literal> const& lits
+  ) -> template_literal {
+    template_literal v = _fresh(t);
+
+    // v <-> (l1 && ... && ln) == (!v || l1) && ... && (!v || ln) && 
+    //                            (v || !l1 || ... || !ln)
+    for(template_literal l : lits)
+      _add(t, {!v, l});
+
+    t.literals.push_back(v);
+    for(template_literal l : lits)
+      t.literals.push_back(!l);
+    t.ends.push_back(t.literals.size());
+
+    return v;
+  }
+
+  auto clausal_encoder::_equiv(
+    clause_template &t, template_literal a, template_literal b
+  ) -> template_literal {
+    template_literal v = _fresh(t);
+
+    // v <-> (a <-> b) == (!v || !a ||  b) && (!v || a || !b) &&
+    //                    ( v || !a || !b) && ( v || a ||  b)
+    _add(t, {!v, !a, b});
+    _add(t, {!v, a, !b});
+    _add(t, {v, !a, !b});
+    _add(t, {v, a, b});
+
+    return v;
+  }
+
+  //
+  // Adds the definitions to the step template. The polarity of each element
+  // is propagated from the formula, which is asserted, and from the elements
+  // used in both directions by the other templates, down to the operands.
+  // Definitions come after those of their operands, so a reverse sweep sees
+  // each element after all the elements it occurs in.
+  //
+  void clausal_encoder::_build_definitions()
+  {
+    constexpr uint8_t positive = 1;
+    constexpr uint8_t negative = 2;
+
+    std::vector<uint8_t> polarity(_block_size, 0);
+    auto occurs = [&](step_literal l, uint8_t p) {
+      if(!l.sign)
+        p = ((p & positive) ? negative : 0) | ((p & negative) ? positive : 0);
+      polarity[l.offset] |= p;
+    };
+
+    occurs(_frm, positive);
+    for(xrequest const& req : _xrequests) {
+      occurs(req.operand, positive | negative);
+      if(req.eventuality)
+        occurs(*req.eventuality, positive | negative);
+    }
+    for(auto const *reqs : {&_yrequests, &_zrequests})
+      for(yzrequest const& req : *reqs)
+        occurs(req.operand, positive | negative);
+
+    if(_encoding == cnf_encoding::tseitin)
+      std::fill(polarity.begin(), polarity.end(), positive | negative);
+
+    for(auto it = _definitions.rbegin(); it != _definitions.rend(); ++it) {
+      template_literal v = _at({true, it->var}, 0);
+      template_literal a = _at(it->a, 0);
+      template_literal b = _at(it->b, 0);
+      uint8_t p = polarity[it->var];
+
+      occurs(it->a, p);
+      occurs(it->b, p);
+      if(it->c)
+        occurs(*it->c, p);
+
+      if(!it->c) {
+        // v <-> (a && b) == (!v || a) && (!v || b) && (v || !a || !b)
+        if(p & positive) {
+          _add(_step, {!v, a});
+          _add(_step, {!v, b});
+        }
+        if(p & negative)
+          _add(_step, {v, !a, !b});
+        continue;
+      }
+
+      // v <-> (a && (b || c)) == (!v || a) && (!v || b || c) &&
+      //                          (v || !a || !b) && (v || !a || !c)
+      template_literal c = _at(*it->c, 0);
+      if(p & positive) {
+        _add(_step, {!v, a});
+        _add(_step, {!v, b, c});
+      }
+      if(p & negative) {
+        _add(_step, {v, !a, !b});
+        _add(_step, {v, !a, !c});
+      }
+    }
+  }
+
+  void clausal_encoder::_build_templates() 
+  {
+    _build_definitions();
+
+    // initial constraints on the formula and the Y/Z-requests
+    _add(_initial, {_at(_frm, 0)});
+    for(yzrequest const& req : _yrequests)
+      _add(_initial, {_at({false, req.var}, 0)});
+    for(yzrequest const& req : _zrequests)
+      _add(_initial, {_at({true, req.var}, 0)});
+
+    // STEP
+    // X(\alpha)_G^{k} <-> snf(\alpha)_G^{k+1}
+    for(xrequest const& req : _xrequests) {
+      template_literal x = _at({true, req.var}, 1);
+      template_literal op = _at(req.operand, 0);
+      _add(_transition, {!x, op});
+      _add(_transition, {x, !op});
+    }
+
+    // YESTERDAY and W-YESTERDAY
+    // Y/Z(\alpha)_G^{k+1} <-> snf(\alpha)_G^{k}
+    auto make_yz = [&](yzrequest const& req) {
+      template_literal yz = _at({true, req.var}, 0);
+      template_literal op = _at(req.operand, 1);
+      _add(_transition, {!yz, op});
+      _add(_transition, {yz, !op});
+    };
+
+    for(yzrequest const& req : _yrequests)
+      make_yz(req);
+    for(yzrequest const& req : _zrequests)
+      make_yz(req);
+
+    // EMPTY
+    std::vector<template_literal> empty;
+    for(xrequest const& req : _xrequests)
+      if(!_finite || req.strong)
+        empty.push_back(_at({false, req.var}, 0));
+    _conjoin(_empty, empty);
+
+    // _lR_k
+    std::vector<template_literal> loop;
+    auto make_loop = [&](uint32_t var) {
+      loop.push_back(_equiv(_loop, _at({true, var}, 1), _at({true, var}, 0)));
+    };
+
+    auto close_loop = [&](yzrequest const& req) {
+      loop.push_back(
+        _equiv(_loop, _at({true, req.var}, 2), _at(req.operand, 0))
+      );
+    };
+
+    for(xrequest const& req : _xrequests)
+      make_loop(req.var);
+    for(yzrequest const& req : _yrequests)
+      make_loop(req.var);
+    for(yzrequest const& req : _zrequests)
+      make_loop(req.var);
+
+    for(yzrequest const& req : _yrequests)
+      close_loop(req);
+    for(yzrequest const& req : _zrequests)
+      close_loop(req);
+
+    _conjoin(_loop, loop);
+  }
+
+  uint32_t clausal_encoder::_instantiate(
+    clause_template const& t, std::array<uint32_t, 3> blocks
+  ) {
+    uint32_t bases[] = {
+      blocks[0], blocks[1], blocks[2], t.fresh ? _alloc(t.fresh) : 0
+    };
+
+    size_t begin = 0;
+    for(size_t end : t.ends) {
+      _buffer.literals.clear();
+      for(size_t i = begin; i < end; ++i) {
+        template_literal l = t.literals[i];
+        _buffer.literals.push_back({l.sign, bases[l.block] + l.offset});
+      }
+      _sat.assert_clause(_buffer);
+      begin = end;
+    }
+
+    return bases[clause_template::fresh_block];
+  }
+
+  auto clausal_encoder::_lit(step_literal l, size_t k) const -> literal {
+    black_assert(k < _blocks.size());
+    return {l.sign, _blocks[k] + l.offset};
+  }
+
+  auto clausal_encoder::_top() const -> literal {
+    return _lit({true, 0}, 0);
+  }
+
+  uint32_t clausal_encoder::_alloc(uint32_t n) {
+    uint32_t first = _nvars + 1;
+    _nvars += n;
+    _sat.new_vars(n);
+
+    return first;
+  }
+
+  void clausal_encoder::_clause(std::initializer_list<literal> lits) {
+    _buffer.literals.assign(lits);
+    _sat.assert_clause(_buffer);
+  }
+
+  void clausal_encoder::_clause(std::vector<literal> const& lits) {
+    _buffer.literals.assign(lits.begin(), lits.end());
+    _sat.assert_clause(_buffer);
+  }
+
+  auto clausal_encoder::_and(std::vector<literal> const& lits) -> literal {
+    if(lits.empty())
+      return _top();
+    if(lits.size() == 1)
+      return lits[0];
+
+    literal v = {true, _alloc(1)};
+
+    // v <-> (l1 && ... && ln) == (!v || l1) && ... && (!v || ln) && 
+    //                            (v || !l1 || ... || !ln)
+    std::vector<literal> back = {v};
+    for(literal l : lits) {
+      _clause({!v, l});
+      back.push_back(!l);
+    }
+    _clause(back);
+
+    return v;
+  }
+
+  auto clausal_encoder::_or(std::vector<literal> const& lits) -> literal {
+    std::vector<literal> neg;
+    for(literal l : lits)
+      neg.push_back(!l);
+    
+    return !_and(neg);
+  }
+
+  // Asserts the k-unraveling step for the given k.
+  void clausal_encoder::k_unraveling(size_t k) {
+    black_assert(_blocks.size() == k);
+
+    _blocks.push_back(_alloc(_block_size));
+    for(uint32_t offset : _frozen)
+      _sat.freeze(_blocks[k] + offset);
+
+    _instantiate(_step, {_blocks[k]});
+
+    if(k == 0)
+      _instantiate(_initial, {_blocks[0]});
+    else
+      _instantiate(_transition, {_blocks[k], _blocks[k - 1]});
+  }
+
+  // Defines EMPTY_k || LOOP_k, guarded by a fresh literal.
+  // The loop vars are defined outside of the guard, since they are
+  // only needed for the extraction of the loop index from the model.
+  auto clausal_encoder::k_empty_or_loop(size_t k) -> literal {
+    std::vector<literal> disjuncts = {
+      {true, _instantiate(_empty, {_blocks[k]})}
+    };
+
+    if(!_finite) {
+      for(size_t l = 0; l < k; ++l) {
+        literal loop_var = _and({_l_to_k_loop(l, k), _l_to_k_period(l, k)});
+        _loop_vars.insert({{l, k}, loop_var});
+        disjuncts.push_back(loop_var);
+      }
+    }
+
+    literal guard = {true, _alloc(1)};
+    disjuncts.push_back(!guard);
+    _clause(disjuncts);
+
+    return guard;
+  }
+
+  // Asserts the negation of the PRUNE encoding
+  void clausal_encoder::k_not_prune(size_t k) {
+    for(size_t l = 0; l < k; ++l) {
+      for(size_t j = l + 1; j < k; ++j) {
+        _clause({
+          !_l_to_k_loop(l, j), !_l_to_k_loop(j, k), !_l_j_k_prune(l, j, k)
+        });
+      }
+    }
+  }
+
+  // Generates the encoding for _lR_k
+  auto clausal_encoder::_l_to_k_loop(size_t l, size_t k) -> literal {
+    if(auto it = _loops.find({l, k}); it != _loops.end())
+      return it->second;
+
+    uint32_t fresh = 
+      _instantiate(_loop, {_blocks[k], _blocks[l], _blocks[l + 1]});
+    literal result = {true, fresh + _loop.fresh - 1};
+    _loops.insert({{l, k}, result});
+    _sat.freeze(result.var);
+
+    return result;
+  }
+
+  // Generates the encoding for _lP_k
+  auto clausal_encoder::_l_to_k_period(size_t l, size_t k) -> literal {
+    std::vector<literal> conjuncts;
+    for(xrequest const& req : _xrequests) {
+      if(!req.eventuality)
+        continue;
+
+      std::vector<literal> disjuncts = {_lit({false, req.var}, k)};
+      for(size_t i = l + 1; i <= k; ++i)
+        disjuncts.push_back(_lit(*req.eventuality, i));
+
+      conjuncts.push_back(_or(disjuncts));
+    }
+
+    return _and(conjuncts);
+  }
+
+  // Generates the _lPRUNE_j^k encoding
+  auto clausal_encoder::_l_j_k_prune(size_t l, size_t j, size_t k) -> literal
+  {
+    std::vector<literal> conjuncts;
+    for(xrequest const& req : _xrequests) {
+      if(!req.eventuality)
+        continue;
+
+      std::vector<literal> disjuncts = {
+        _lit({false, req.var}, k), !_eventually_between(req, j + 1, k + 1)
+      };
+      for(size_t i = l + 1; i <= j; ++i)
+        disjuncts.push_back(_lit(*req.eventuality, i));
+
+      conjuncts.push_back(_or(disjuncts));
+    }
+
+    return _and(conjuncts);
+  }
+
+  auto clausal_encoder::_eventually_between(
+    xrequest const& req, size_t begin, size_t end
+  ) -> literal {
+    black_assert(req.eventuality.has_value());
+
+    std::vector<literal> disjuncts;
+    for(size_t i = begin; i < end; ++i)
+      disjuncts.push_back(_lit(*req.eventuality, i));
+
+    return _or(disjuncts);
+  }
+
+  static tribool value_of(sat::dimacs::solver const& sat, 
+                          clausal_encoder::literal lit) 
+  {
+    tribool v = sat.value(lit.var);
+    if(v == tribool::undef)
+      return tribool::undef;
+
+    return static_cast<bool>(v) == lit.sign;
+  }
+
+  tribool clausal_encoder::value(formula f, size_t k) const {
+    auto it = _closure.find(f);
+    if(it == _closure.end() || k >= _blocks.size())
+      return tribool::undef;
+
+    return value_of(_sat, _lit(it->second, k));
+  }
+
+  void clausal_encoder::values(
+    formula f, size_t n, std::vector<tribool> &out
+  ) const {
+    auto it = _closure.find(f);
+    for(size_t k = 0; k < n; ++k) {
+      if(it == _closure.end() || k >= _blocks.size())
+        out.push_back(tribool::undef);
+      else
+        out.push_back(value_of(_sat, _lit(it->second, k)));
+    }
+  }
+
+  tribool clausal_encoder::loop_value(size_t l, size_t k) const {
+    auto it = _loop_vars.find({l, k});
+    if(it == _loop_vars.end())
+      return tribool::undef;
+
+    return value_of(_sat, it->second);
+  }
+}
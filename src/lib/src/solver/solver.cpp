@@ -27,7 +27,9 @@
 #include <black/support/range.hpp>
 #include <black/solver/solver.hpp>
 #include <black/solver/encoding.hpp>
+#include <black/solver/clausal.hpp>
 #include <black/sat/solver.hpp>
+#include <black/sat/dimacs.hpp>
 
 namespace black::internal
 {
@@ -38,6 +40,9 @@ namespace black::internal
   {
     std::optional<struct encoder> encoder;
 
+    // clause-level encoder, used when the backend is DIMACS-based
+    std::optional<clausal_encoder> clausal;
+
     // whether a model has been found 
     // i.e., whether solve() has been called and returned true
     bool model = false;
@@ -54,8 +59,17 @@ namespace black::internal
     // the name of the currently chosen sat backend
     std::string sat_backend = BLACK_DEFAULT_BACKEND; // sensible default
 
+    // tuning options for the sat backend
+    sat::options sat_options;
+
+    // kind of CNF definitions used by clausal_encoder
+    cnf_encoding encoding = cnf_encoding::tseitin;
+
     // Main algorithm
     tribool solve(size_t k_max);
+
+    // Main algorithm, on top of the clause-level encoding
+    tribool solve(sat::dimacs::solver &dimacs, size_t k_max);
   };
 
   solver::solver() : _data{std::make_unique<_solver_t>()} { }
@@ -65,6 +79,7 @@ namespace black::internal
     _data->model = false;
     _data->model_size = 0;
     _data->last_bound = 0;
+    _data->clausal.reset();
     _data->encoder = encoder{f, finite};
   }
 
@@ -91,6 +106,18 @@ namespace black::internal
     return _data->sat_backend;
   }
 
+  void solver::set_sat_option(std::string name, sat::option_value value) {
+    _data->sat_options.insert_or_assign(std::move(name), std::move(value));
+  }
+
+  void solver::set_cnf_encoding(cnf_encoding encoding) {
+    _data->encoding = encoding;
+  }
+
+  cnf_encoding solver::get_cnf_encoding() const {
+    return _data->encoding;
+  }
+
   size_t model::size() const {
     return _solver._data->model_size;
   }
@@ -101,8 +128,13 @@ namespace black::internal
     
     size_t k = size() - 1;
     for(size_t l = 0; l < k; ++l) {
-      atom loop_var = _solver._data->encoder->loop_var(l, k);
-      tribool value = _solver._data->sat->value(loop_var);
+      tribool value = tribool::undef;
+      if(_solver._data->clausal) 
+        value = _solver._data->clausal->loop_value(l, k);
+      else {
+        atom loop_var = _solver._data->encoder->loop_var(l, k);
+        value = _solver._data->sat->value(loop_var);
+      }
       
       if(value == true)
         return l + 1;
@@ -113,12 +145,39 @@ namespace black::internal
 
   tribool model::value(atom a, size_t t) const {
     black_assert(_solver._data->encoder);
+
+    if(_solver._data->clausal)
+      return _solver._data->clausal->value(a, t);
     
     atom u = _solver._data->encoder->ground(a, t);
 
     return _solver._data->sat->value(u);
   }
 
+  model::matrix model::extract(std::vector<atom> atoms) const {
+    black_assert(_solver._data->encoder);
+
+    matrix m;
+    m.size = size();
+    m.loop = loop();
+    m.values.reserve(atoms.size() * m.size);
+
+    for(atom a : atoms) {
+      if(_solver._data->clausal) {
+        _solver._data->clausal->values(a, m.size, m.values);
+        continue;
+      }
+
+      for(size_t t = 0; t < m.size; ++t)
+        m.values.push_back(
+          _solver._data->sat->value(_solver._data->encoder->ground(a, t))
+        );
+    }
+
+    m.atoms = std::move(atoms);
+    return m;
+  }
+
   /*
    * Main algorithm. Solve the formula with up to `k_max' iterations
    */
@@ -127,7 +186,13 @@ namespace black::internal
     if(!encoder)
       return tribool::undef;
     
-    sat = sat::solver::get_solver(sat_backend);
+    clausal.reset();
+    sat = sat::solver::get_solver(sat_backend, sat_options);
+    if(!sat)
+      return tribool::undef;
+    
+    if(auto *dimacs = dynamic_cast<sat::dimacs::solver *>(sat.get()); dimacs)
+      return solve(*dimacs, k_max);
 
     model = false;
     last_bound = 0;
@@ -158,4 +223,36 @@ namespace black::internal
     return tribool::undef;
   }
 
+  /*
+   * Same as above, but with the clauses emitted directly by clausal_encoder
+   */
+  tribool solver::_solver_t::solve(sat::dimacs::solver &dimacs, size_t k_max)
+  {
+    // clausal_encoder freezes the variables it uses across steps
+    dimacs.enable_elimination();
+    clausal.emplace(*encoder, dimacs, encoding);
+
+    model = false;
+    last_bound = 0;
+    for(size_t k = 0; k <= k_max; last_bound = k++)
+    {
+      clausal->k_unraveling(k);
+      if(!dimacs.is_sat())
+        return false;
+
+      if(dimacs.is_sat_with({clausal->k_empty_or_loop(k)})) {
+        model_size = k + 1;
+        model = true;
+        
+        return true;
+      }
+
+      clausal->k_not_prune(k);
+      if(!dimacs.is_sat())
+        return false;
+    } // end for
+
+    return tribool::undef;
+  }
+
 } // end namespace black::size_ternal
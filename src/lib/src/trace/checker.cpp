@@ -0,0 +1,450 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <black/trace/checker.hpp>
+#include <black/logic/alphabet.hpp>
+#include <black/support/assert.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace black::internal
+{
+  namespace {
+    // Past depth of a formula, i.e. how many times the loop of the trace has
+    // to be unrolled to label it. Shared subformulas are visited only once.
+    static
+    size_t depth(formula f, std::unordered_map<formula, size_t> &memo) {
+      if(auto it = memo.find(f); it != memo.end())
+        return it->second;
+
+      size_t d = f.match(
+        [](boolean) -> size_t { return 1; },
+        [](atom) -> size_t { return 1; },
+        [&](yesterday, formula op) { return 1 + depth(op, memo); },
+        [&](w_yesterday, formula op) { return 1 + depth(op, memo); },
+        [&](once, formula op) { return 1 + depth(op, memo); },
+        [&](historically, formula op) { return 1 + depth(op, memo); },
+        [&](since, formula l, formula r) {
+          return 1 + std::max(depth(l, memo), depth(r, memo));
+        },
+        [&](triggered, formula l, formula r) {
+          return 1 + std::max(depth(l, memo), depth(r, memo));
+        },
+        [&](unary, formula op) {
+          return depth(op, memo);
+        },
+        [&](binary, formula l, formula r) {
+          return std::max(depth(l, memo), depth(r, memo));
+        }
+      );
+
+      memo.insert({f, d});
+      return d;
+    }
+
+    //
+    // Bottom-up labelling of a formula over a trace. Each subformula is
+    // labelled with its truth value at all the positions of the trace at once,
+    // with a single sweep over the labels of its operands: forward for past
+    // operators and backward for future ones. Hence checking takes 
+    // O(|f|·|trace|) time overall.
+    //
+    // Labels are bitsets over the positions, so that boolean operators and
+    // X/Y are evaluated 64 positions at a time with word-level operations,
+    // and the recurrences behind temporal operators, which all have the form
+    // `u[t] = g[t] || (p[t] && u[t ± 1])`, are solved for a whole word at a
+    // time with a Kogge-Stone prefix scan.
+    //
+    // On infinite traces, the loop is unrolled once for each level of nesting
+    // of past operators, after which the labels of all the subformulas are
+    // periodic. Future operators then close the loop with a fixpoint: the
+    // first backward sweep starts from the least (or greatest) fixpoint and 
+    // gets the right value at the start of the loop, and the second sweep 
+    // propagates it to the rest of the trace.
+    //
+    class labelling {
+    public:
+      // labels formulas with up to `depth - 1` nested past operators
+      labelling(
+        trace const&t, bool finite, size_t depth, 
+        trace_checker::tracer_t const&tracer
+      );
+
+      size_t depth() const { return _depth; }
+
+      // value of the formula at the given position of the trace
+      bool at(formula f, size_t t);
+
+    private:
+      // bits past the last position in the last word are unspecified
+      using label_t = std::vector<uint64_t>;
+
+      label_t const&label(formula f);
+      label_t compute(formula f);
+      label_t label_atom(atom a);
+
+      static bool test(label_t const&l, size_t t) {
+        return (l[t / 64] >> (t % 64)) & 1;
+      }
+
+      template<typename F>
+      label_t pointwise(F op) const;
+
+      // labels of X/wX (`last` is the value at the end of finite traces) and 
+      // of Y/Z (`first` is the value at the first position)
+      label_t next(label_t const&o, bool last) const;
+      label_t prev(label_t const&o, bool first) const;
+
+      // solutions to `u[t] = g[t] || (p[t] && u[t - 1])`, where `before` is 
+      // the value before the first position, and to 
+      // `u[t] = g[t] || (p[t] && u[t + 1])`, where `after` is the value after 
+      // the end of finite traces and the extremal fixpoint on infinite ones.
+      label_t forward(label_t g, label_t p, bool before) const;
+      label_t backward(label_t const&g, label_t const&p, bool after) const;
+      label_t backward_sweep(label_t g, label_t p, bool after) const;
+
+      // index of the state of the trace at position t, if any
+      std::optional<size_t> state(size_t t) const;
+
+      trace const&_trace;
+      bool _finite;
+      size_t _depth;
+      trace_checker::tracer_t const&_tracer;
+
+      // the labelled positions are [0, _size), and the successor of the last
+      // one is _loop, which is equal to _size on finite traces
+      size_t _size = 0;
+      size_t _loop = 0;
+      size_t _words = 0;
+
+      std::unordered_map<formula, label_t> _labels;
+    };
+
+    labelling::labelling(
+      trace const&t, bool finite, size_t depth, 
+      trace_checker::tracer_t const&tracer
+    ) : _trace{t}, _finite{finite}, _depth{depth}, _tracer{tracer}
+    {
+      if(_finite) {
+        _size = _loop = _trace.size();
+      } else {
+        // on infinite traces without a loop, all the states after the end are
+        // don't cares, so we loop over one of them
+        size_t period = std::max<size_t>(_trace.size() - _trace.loop, 1);
+
+        _loop = _trace.loop + period * (_depth - 1);
+        _size = _loop + period;
+      }
+      _words = (_size + 63) / 64;
+    }
+
+    bool labelling::at(formula f, size_t t) {
+      label_t const&l = label(f);
+
+      if(t >= _size) {
+        black_assert(!_finite);
+        t = _loop + (t - _loop) % (_size - _loop);
+      }
+    
+      return test(l, t);
+    }
+
+    std::optional<size_t> labelling::state(size_t t) const {
+      if(t < _trace.size())
+        return t;
+    
+      size_t period = _trace.size() - _trace.loop;
+      if(period)
+        return ((t - _trace.loop) % period) + _trace.loop;
+
+      return {};
+    }
+
+    template<typename F>
+    labelling::label_t labelling::pointwise(F op) const {
+      label_t result(_words);
+      for(size_t w = 0; w < _words; ++w)
+        result[w] = op(w);
+    
+      return result;
+    }
+
+    labelling::label_t labelling::next(label_t const&o, bool last) const {
+      label_t result = pointwise([&](size_t w) {
+        uint64_t carry = w + 1 < _words ? o[w + 1] << 63 : 0;
+        return (o[w] >> 1) | carry;
+      });
+
+      if(_loop < _size)
+        last = test(o, _loop);
+
+      uint64_t bit = uint64_t{1} << ((_size - 1) % 64);
+      result.back() = last ? result.back() | bit : result.back() & ~bit;
+
+      return result;
+    }
+
+    labelling::label_t labelling::prev(label_t const&o, bool first) const {
+      return pointwise([&](size_t w) {
+        uint64_t carry = w > 0 ? o[w - 1] >> 63 : uint64_t{first};
+        return (o[w] << 1) | carry;
+      });
+    }
+
+    labelling::label_t 
+    labelling::forward(label_t g, label_t p, bool before) const {
+      uint64_t carry = before;
+      for(size_t w = 0; w < _words; ++w) {
+        for(unsigned k = 1; k < 64; k *= 2) {
+          g[w] |= p[w] & (g[w] << k);
+          p[w] &= (p[w] << k) | ((uint64_t{1} << k) - 1);
+        }
+        g[w] |= p[w] & (carry ? ~uint64_t{0} : 0);
+        carry = g[w] >> 63;
+      }
+    
+      return g;
+    }
+
+    labelling::label_t 
+    labelling::backward_sweep(label_t g, label_t p, bool after) const {
+      // positions past the end propagate the value that follows the trace
+      if(uint64_t rest = _size % 64; rest) {
+        uint64_t valid = (uint64_t{1} << rest) - 1;
+        g.back() &= valid;
+        p.back() |= ~valid;
+      }
+
+      uint64_t carry = after;
+      for(size_t w = _words; w-- > 0;) {
+        for(unsigned k = 1; k < 64; k *= 2) {
+          g[w] |= p[w] & (g[w] >> k);
+          p[w] &= (p[w] >> k) | ~(~uint64_t{0} >> k);
+        }
+        g[w] |= p[w] & (carry ? ~uint64_t{0} : 0);
+        carry = g[w] & 1;
+      }
+
+      return g;
+    }
+
+    labelling::label_t 
+    labelling::backward(label_t const&g, label_t const&p, bool after) const {
+      // positions before the loop do not affect the value at the loop start,
+      // so the first sweep can go over the whole trace
+      if(_loop < _size)
+        after = test(backward_sweep(g, p, after), _loop);
+
+      return backward_sweep(g, p, after);
+    }
+
+    labelling::label_t const&labelling::label(formula f) {
+      if(auto it = _labels.find(f); it != _labels.end())
+        return it->second;
+
+      label_t result = compute(f);
+
+      if(_tracer)
+        for(size_t t = 0; t < _size; ++t)
+          _tracer(f, t, test(result, t));
+    
+      return _labels.insert({f, std::move(result)}).first->second;
+    }
+
+    labelling::label_t labelling::label_atom(atom a) {
+      black_assert(a.label<std::string>().has_value());
+      std::optional<size_t> p = _trace.index(*a.label<std::string>());
+
+      label_t result(_words, ~uint64_t{0});
+      if(!p)
+        return result;
+
+      // undefined values and the states at the end of a non-looping model are
+      // don't cares, so we return true (we may choose false as well)
+      size_t prefix = std::min(_trace.size(), _size);
+      for(size_t w = 0; w < (prefix + 63) / 64; ++w) {
+        auto [known, value] = _trace.word(*p, w);
+        result[w] = ~known | value;
+      }
+
+      for(size_t t = prefix; t < _size; ++t) {
+        std::optional<size_t> s = state(t);
+        uint64_t bit = uint64_t{1} << (t % 64);
+        if(s && _trace.value(*p, *s) == false)
+          result[t / 64] &= ~bit;
+        else
+          result[t / 64] |= bit;
+      }
+
+      return result;
+    }
+
+    labelling::label_t labelling::compute(formula f) {
+      return f.match(
+        [&](boolean b) {
+          return label_t(_words, b.value() ? ~uint64_t{0} : 0);
+        },
+        [&](atom a) {
+          return label_atom(a);
+        },
+        [&](negation, formula op) {
+          label_t const&o = label(op);
+          return pointwise([&](size_t w) { return ~o[w]; });
+        },
+        [&](conjunction, formula l, formula r) {
+          label_t const&a = label(l);
+          label_t const&b = label(r);
+          return pointwise([&](size_t w) { return a[w] & b[w]; });
+        },
+        [&](disjunction, formula l, formula r) {
+          label_t const&a = label(l);
+          label_t const&b = label(r);
+          return pointwise([&](size_t w) { return a[w] | b[w]; });
+        },
+        [&](implication, formula l, formula r) {
+          label_t const&a = label(l);
+          label_t const&b = label(r);
+          return pointwise([&](size_t w) { return ~a[w] | b[w]; });
+        },
+        [&](iff, formula l, formula r) {
+          label_t const&a = label(l);
+          label_t const&b = label(r);
+          return pointwise([&](size_t w) { return ~(a[w] ^ b[w]); });
+        },
+        [&](tomorrow, formula op) {
+          return next(label(op), false);
+        },
+        [&](w_tomorrow, formula op) {
+          return next(label(op), true);
+        },
+        [&](yesterday, formula op) {
+          return prev(label(op), false);
+        },
+        [&](w_yesterday, formula op) {
+          return prev(label(op), true);
+        },
+        [&](eventually, formula op) {
+          return backward(label(op), label_t(_words, ~uint64_t{0}), false);
+        },
+        [&](always, formula op) {
+          return backward(label_t(_words, 0), label(op), true);
+        },
+        [&](until, formula l, formula r) {
+          return backward(label(r), label(l), false);
+        },
+        [&](w_until, formula l, formula r) {
+          return backward(label(r), label(l), true);
+        },
+        [&](release, formula l, formula r) {
+          label_t const&a = label(l);
+          label_t const&b = label(r);
+          return backward(
+            pointwise([&](size_t w) { return a[w] & b[w]; }), b, true
+          );
+        },
+        [&](s_release, formula l, formula r) {
+          label_t const&a = label(l);
+          label_t const&b = label(r);
+          return backward(
+            pointwise([&](size_t w) { return a[w] & b[w]; }), b, false
+          );
+        },
+        [&](once, formula op) {
+          return forward(label(op), label_t(_words, ~uint64_t{0}), false);
+        },
+        [&](historically, formula op) {
+          return forward(label_t(_words, 0), label(op), true);
+        },
+        [&](since, formula l, formula r) {
+          return forward(label(r), label(l), false);
+        },
+        [&](triggered, formula l, formula r) {
+          label_t const&a = label(l);
+          label_t const&b = label(r);
+          return forward(
+            pointwise([&](size_t w) { return a[w] & b[w]; }), b, true
+          );
+        }
+      );
+    }
+  }
+
+  struct trace_checker::_checker_t {
+    trace const&t;
+    bool finite;
+    tracer_t tracer;
+
+    // labelling for the deepest formula checked so far
+    std::optional<labelling> labels;
+
+    _checker_t(trace const&_t, bool _finite) : t{_t}, finite{_finite} { }
+
+    // deeper formulas need the loop to be unrolled more, so the labels 
+    // computed so far are thrown away
+    void unroll(size_t d) {
+      if(!labels || labels->depth() < d)
+        labels.emplace(t, finite, d, tracer);
+    }
+  };
+
+  trace_checker::trace_checker(trace const&t, bool finite)
+    : _data{std::make_unique<_checker_t>(t, finite)} { }
+
+  trace_checker::~trace_checker() = default;
+
+  void trace_checker::set_tracer(tracer_t tracer) {
+    _data->tracer = std::move(tracer);
+  }
+
+  bool trace_checker::check(formula f, size_t t) {
+    black_assert(!_data->finite || t < _data->t.size());
+
+    std::unordered_map<formula, size_t> memo;
+    _data->unroll(depth(f, memo));
+
+    return _data->labels->at(f, t);
+  }
+
+  std::vector<bool> 
+  trace_checker::check(std::vector<formula> const&fs, size_t t) {
+    black_assert(!_data->finite || t < _data->t.size());
+
+    // the loop is unrolled for the deepest formula upfront, so that the 
+    // labels are shared by all of them
+    std::unordered_map<formula, size_t> memo;
+    size_t d = 0;
+    for(formula f : fs)
+      d = std::max(d, depth(f, memo));
+    _data->unroll(d);
+
+    std::vector<bool> result;
+    for(formula f : fs)
+      result.push_back(_data->labels->at(f, t));
+
+    return result;
+  }
+}
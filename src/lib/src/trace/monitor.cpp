@@ -0,0 +1,292 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <black/trace/monitor.hpp>
+#include <black/logic/alphabet.hpp>
+#include <black/support/assert.hpp>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace black::internal
+{
+  struct monitor::_monitor_t 
+  {
+    // a subformula, compiled into a node of the evaluation DAG
+    struct node_t {
+      formula::type type;
+      bool value = false; // for booleans
+      size_t atom = 0;    // for atoms, index into `atoms`
+      size_t left = 0;    // operands, as indices into `nodes`
+      size_t right = 0;
+      size_t delay = 0;   // nesting of X/wX operators
+    };
+
+    // the nodes, with operands always before the formulas that use them, 
+    // so that the formula itself is the last one
+    std::vector<node_t> nodes;
+    std::vector<atom> atoms;
+
+    // Each node is evaluated at position p when state p + delay is fed, and
+    // it needs the values of its operands up to `delay + 1` positions before,
+    // so the values of the last `delay + 2` positions of each node are kept
+    // in a ring buffer
+    size_t window = 0;
+    std::vector<uint8_t> values;
+
+    size_t size = 0;
+    bool finished = false;
+
+    explicit _monitor_t(formula f);
+    
+    size_t compile(formula f, std::unordered_map<formula, size_t> &memo);
+
+    uint8_t &value(size_t node, size_t p) {
+      return values[node * window + p % window];
+    }
+
+    // evaluates the nodes that get determined when state `n` is fed, where 
+    // states past the end of the trace are never fed
+    void evaluate(size_t n);
+
+    node_t const&root() const { return nodes.back(); }
+  };
+
+  monitor::_monitor_t::_monitor_t(formula f) {
+    std::unordered_map<formula, size_t> memo;
+    compile(f, memo);
+
+    window = root().delay + 2;
+    values.resize(nodes.size() * window);
+  }
+
+  size_t monitor::_monitor_t::compile(
+    formula f, std::unordered_map<formula, size_t> &memo
+  ) {
+    if(auto it = memo.find(f); it != memo.end())
+      return it->second;
+    
+    node_t node{f.formula_type()};
+    f.match(
+      [&](boolean b) {
+        node.value = b.value();
+      },
+      [&](atom a) {
+        node.atom = atoms.size();
+        atoms.push_back(a);
+      },
+      [&](unary u, formula op) {
+        node.left = compile(op, memo);
+        node.delay = nodes[node.left].delay;
+        if(u.formula_type() == unary::type::tomorrow || 
+           u.formula_type() == unary::type::w_tomorrow)
+          node.delay++;
+      },
+      [&](binary, formula l, formula r) {
+        node.left = compile(l, memo);
+        node.right = compile(r, memo);
+        node.delay = std::max(nodes[node.left].delay, nodes[node.right].delay);
+      }
+    );
+
+    nodes.push_back(node);
+    memo.insert({f, nodes.size() - 1});
+
+    return nodes.size() - 1;
+  }
+
+  void monitor::_monitor_t::evaluate(size_t n) {
+    using type = formula::type;
+
+    for(size_t i = 0; i < nodes.size(); ++i) {
+      node_t const&node = nodes[i];
+      if(n < node.delay || n - node.delay >= size)
+        continue;
+      
+      size_t p = n - node.delay;
+      auto l = [&](size_t t) -> bool { return value(node.left, t); };
+      auto r = [&](size_t t) -> bool { return value(node.right, t); };
+      auto prev = [&](bool first) -> bool { 
+        return p == 0 ? first : value(i, p - 1);
+      };
+
+      bool result = false;
+      switch(node.type) {
+        case type::boolean:
+          result = node.value;
+          break;
+        case type::atom: // already set by step()
+          continue;
+        case type::negation:
+          result = !l(p);
+          break;
+        case type::conjunction:
+          result = l(p) && r(p);
+          break;
+        case type::disjunction:
+          result = l(p) || r(p);
+          break;
+        case type::implication:
+          result = !l(p) || r(p);
+          break;
+        case type::iff:
+          result = l(p) == r(p);
+          break;
+        case type::tomorrow:
+          result = p + 1 < size && l(p + 1);
+          break;
+        case type::w_tomorrow:
+          result = p + 1 >= size || l(p + 1);
+          break;
+        case type::yesterday:
+          result = p > 0 && l(p - 1);
+          break;
+        case type::w_yesterday:
+          result = p == 0 || l(p - 1);
+          break;
+        case type::once:
+          result = l(p) || prev(false);
+          break;
+        case type::historically:
+          result = l(p) && prev(true);
+          break;
+        case type::since:
+          result = r(p) || (l(p) && prev(false));
+          break;
+        case type::triggered:
+          result = r(p) && (l(p) || prev(true));
+          break;
+        case type::always:
+        case type::eventually:
+        case type::until:
+        case type::release:
+        case type::w_until:
+        case type::s_release:
+          black_unreachable(); // LCOV_EXCL_LINE
+      }
+
+      value(i, p) = result;
+    }
+  }
+
+  monitor::monitor(formula f) {
+    black_assert(!monitorable(f).has_value());
+    _data = std::make_unique<_monitor_t>(f);
+  }
+
+  monitor::~monitor() = default;
+
+  monitor::monitor(monitor &&) = default;
+  monitor &monitor::operator=(monitor &&) = default;
+
+  // Implementation of monitor::monitorable(). Subformulas already visited
+  // are known to be monitorable, so shared ones are checked only once.
+  static std::optional<std::string> 
+  monitorable(formula f, std::unordered_set<formula> &visited) {
+    if(!visited.insert(f).second)
+      return {};
+
+    return f.match(
+      [](boolean) -> std::optional<std::string> { return {}; },
+      [](atom) -> std::optional<std::string> { return {}; },
+      [](always) -> std::optional<std::string> { 
+        return "the G operator cannot be monitored";
+      },
+      [](eventually) -> std::optional<std::string> { 
+        return "the F operator cannot be monitored";
+      },
+      [](until) -> std::optional<std::string> { 
+        return "the U operator cannot be monitored";
+      },
+      [](release) -> std::optional<std::string> { 
+        return "the R operator cannot be monitored";
+      },
+      [](w_until) -> std::optional<std::string> { 
+        return "the W operator cannot be monitored";
+      },
+      [](s_release) -> std::optional<std::string> { 
+        return "the M operator cannot be monitored";
+      },
+      [&](unary, formula op) {
+        return monitorable(op, visited);
+      },
+      [&](binary, formula l, formula r) {
+        if(auto error = monitorable(l, visited); error)
+          return error;
+        return monitorable(r, visited);
+      }
+    );
+  }
+
+  std::optional<std::string> monitor::monitorable(formula f) {
+    std::unordered_set<formula> visited;
+    return internal::monitorable(f, visited);
+  }
+
+  std::vector<atom> const&monitor::atoms() const {
+    return _data->atoms;
+  }
+
+  size_t monitor::delay() const {
+    return _data->root().delay;
+  }
+
+  size_t monitor::size() const {
+    return _data->size;
+  }
+
+  std::optional<bool> monitor::step(std::vector<tribool> const&state) {
+    black_assert(!_data->finished);
+    black_assert(state.size() == _data->atoms.size());
+
+    size_t n = _data->size++;
+    for(size_t i = 0; i < _data->nodes.size(); ++i) {
+      auto const&node = _data->nodes[i];
+      if(node.type == formula::type::atom)
+        _data->value(i, n) = state[node.atom] != false;
+    }
+
+    _data->evaluate(n);
+
+    if(n < delay())
+      return {};
+    return _data->value(_data->nodes.size() - 1, n - delay());
+  }
+
+  std::vector<bool> monitor::finish() {
+    black_assert(!_data->finished);
+    _data->finished = true;
+
+    std::vector<bool> verdicts;
+    size_t size = _data->size;
+    for(size_t n = size; n < size + delay(); ++n) {
+      _data->evaluate(n);
+      if(n >= delay())
+        verdicts.push_back(_data->value(_data->nodes.size() - 1, n - delay()));
+    }
+
+    return verdicts;
+  }
+}
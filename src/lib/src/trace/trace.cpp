@@ -0,0 +1,85 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <black/trace/trace.hpp>
+#include <black/support/assert.hpp>
+
+namespace black::internal
+{
+  std::optional<size_t> trace::index(std::string const& name) const {
+    if(auto it = _indices.find(name); it != _indices.end())
+      return it->second;
+    return {};
+  }
+
+  size_t trace::intern(std::string const& name) {
+    auto [it, inserted] = _indices.insert({name, _columns.size()});
+    if(inserted)
+      _columns.emplace_back();
+    return it->second;
+  }
+
+  tribool trace::value(size_t p, size_t t) const {
+    black_assert(p < _columns.size());
+    black_assert(t < _size);
+
+    column_t const& c = _columns[p];
+    size_t word = t / 64;
+    uint64_t bit = uint64_t{1} << (t % 64);
+    
+    if(word >= c.known.size() || !(c.known[word] & bit))
+      return tribool::undef;
+    return (c.value[word] & bit) != 0;
+  }
+
+  std::pair<uint64_t, uint64_t> trace::word(size_t p, size_t w) const {
+    black_assert(p < _columns.size());
+    column_t const& c = _columns[p];
+
+    if(w >= c.known.size())
+      return {0, 0};
+    return {c.known[w], c.value[w]};
+  }
+
+  void trace::set(size_t p, size_t t, tribool v) {
+    black_assert(p < _columns.size());
+    black_assert(t < _size);
+
+    column_t &c = _columns[p];
+    size_t word = t / 64;
+    uint64_t bit = uint64_t{1} << (t % 64);
+
+    if(word >= c.known.size()) {
+      c.known.resize(word + 1);
+      c.value.resize(word + 1);
+    }
+
+    c.known[word] &= ~bit;
+    c.value[word] &= ~bit;
+    if(v != tribool::undef)
+      c.known[word] |= bit;
+    if(v == true)
+      c.value[word] |= bit;
+  }
+}
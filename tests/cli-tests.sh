@@ -106,6 +106,23 @@ cat <<END | should_fail ./black check -t - -f 'p'
 }
 END
 
+cat <<END | ./black check -t - -f 'p'
+{
+  "result": "SAT",
+  "k": 1,
+  "model": {
+    "size": 1,
+    "loop": 0,
+    "extra": [{ "nested": [1, 2] }],
+    "states": [
+      {
+        "p": "true"
+      }
+    ]
+  }
+}
+END
+
 cat <<END | ./black check -t - -f 'q'
 {
   "model": {
@@ -120,13 +137,107 @@ cat <<END | ./black check -t - -f 'q'
 }
 END
 
+./black solve -m -o json -f 'G F p && F !p' > trace.json
+./black check -t trace.json -f 'G F p' -f 'F p' | grep -q 'F p: TRUE'
+should_fail ./black check -t trace.json -f 'G F p' -f 'G p'
+rm trace.json
+
+./black solve --remove-past -o json -f 'Y p && X Y p' | grep -q translated_size
+
+./black solve -m -o binary -f 'G F p && F !p' > trace.bin
+./black check -t trace.bin -f 'G F p' | grep -q TRUE
+./black solve --finite -m -o binary -f 'p U q' | ./black check --finite -t - -f 'p U q'
+./black solve -o binary -f 'p && !p' | ./black check -e UNSAT -t - -f 'p'
+head -c 20 trace.bin | should_fail ./black check -t - -f 'p'
+should_fail ./black check --finite -t trace.bin -f 'G F p'
+./black solve --finite -m -o binary -f 'p U q' > trace.bin
+should_fail ./black check -t trace.bin -f 'G p'
+./black solve -o binary -f 'p' | should_fail ./black check -t - -f 'p'
+rm trace.bin
+
+mkdir -p traces
+./black solve -m -o json -f 'G F p' > traces/gf.json
+./black solve -m -o json -f 'G !p' > traces/gnot.json
+./black check --batch traces -j 2 -f 'G F p || G !p'
+ls traces/*.json | ./black check --batch - -f 'G F p || G !p'
+should_fail ./black check --batch traces -f 'G F p'
+should_fail ./black check --batch traces --verbose -f 'G F p'
+should_fail ./black check --batch traces -t - -f 'G F p'
+should_fail ./black check --batch traces -f 'G F p' -f 'F p'
+rm -r traces
+
+cat <<END | ./black monitor -f 'p S q' | grep -q '2: TRUE'
+{"p": "true", "q": "false"}
+{"p": "false", "q": "true"}
+{"p": "true"}
+END
+cat <<END > events.ndjson
+{"p": "true"}
+{"p": "false"}
+END
+./black monitor -f 'X p' -t events.ndjson | grep -q '1: FALSE'
+should_fail ./black monitor -f 'X p' -t events.ndjson
+should_fail ./black monitor -f 'F p' -t events.ndjson
+echo '{"p": 1}' | should_fail ./black monitor -f 'p'
+echo 'p' | should_fail ./black monitor -
+rm events.ndjson
+
 ./black dimacs ../tests/test-dimacs-sat.cnf | grep -w SATISFIABLE 
 ./black dimacs ../tests/test-dimacs-unsat.cnf | grep -w UNSATISFIABLE 
 
+./black solve -k 2 --record recorded.icnf -f 'G F p && F G !p' | grep UNKNOWN
+./black dimacs recorded.icnf | grep -w UNSATISFIABLE
+./black dimacs -B z3 recorded.icnf | grep -w UNSATISFIABLE
+rm recorded.icnf
+should_fail ./black solve --record /nonexistent/recorded.icnf -f 'p'
+if [ -w /dev/full ]; then
+  should_fail ./black solve --record /dev/full -f 'p'
+  should_fail ./black dimacs --record /dev/full ../tests/test-dimacs-sat.cnf
+fi
+
+should_fail ./black solve -B cdcl -O threads=2 -f 'p'
+./black solve -B z3 -O threads=2 -O seed=3 -f 'G F p' | grep SAT
+./black dimacs -B z3 -O memory=1024 ../tests/test-dimacs-sat.cnf | \
+  grep -w SATISFIABLE
+should_fail ./black solve -B z3 -O unknown=1 -f 'p'
+should_fail ./black solve -B z3 -O threads=many -f 'p'
+
+./black solve -B cdcl --polarity-cnf -m -o json \
+  -f '(a U b) && G(!b || c) && F !c' | \
+  ./black check -t - -e SAT -f '(a U b) && G(!b || c) && F !c'
+./black solve -B cdcl --polarity-cnf -f 'G p && F !p' | grep -w UNSAT
+
 if ./black --sat-backends | grep mathsat; then
   ./black dimacs -B mathsat ../tests/test-dimacs-sat.cnf | grep -w SATISFIABLE 
 fi
 
+if [ -f ./libipasir_stub.so ]; then
+  ./black solve --ipasir stub=./libipasir_stub.so -B stub -f 'G F p' | grep SAT
+  cat <<END | ./black dimacs --ipasir stub=./libipasir_stub.so -B stub - | \
+    grep -w UNSATISFIABLE
+p cnf 2 4
+1 2 0
+-1 2 0
+1 -2 0
+-1 -2 0
+END
+  should_fail ./black solve --ipasir stub=./missing.so -B stub -f 'p'
+  should_fail ./black solve --ipasir z3=./libipasir_stub.so -f 'p'
+fi
+
+should_fail ./black solve -B missing -f 'p'
+
+# backend modules that fail to load are reported, not fatal
+if ls src/lib/libblack-backend-*.so > /dev/null 2>&1; then
+  echo broken > src/lib/libblack-backend-broken.so
+  status=0
+  ./black solve -B broken -f 'p' || status=$?
+  backends=$(./black --sat-backends)
+  rm src/lib/libblack-backend-broken.so
+  [ $status -eq 2 ]
+  echo "$backends" | grep 'broken (unable to load)'
+fi
+
 cat <<END | should_fail ./black dimacs -
 p cnf
 END
@@ -0,0 +1,163 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2021 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//
+// A minimal IPASIR-compliant SAT solver, used to test the IPASIR backend.
+// It is a plain DPLL procedure without any learning, only suitable for 
+// small instances.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+  struct stub_solver {
+    std::vector<std::vector<int32_t>> clauses;
+    std::vector<int32_t> clause;
+    std::vector<int32_t> assumptions;
+    std::vector<int8_t> model;
+    int32_t maxvar = 0;
+  };
+
+  int8_t value(std::vector<int8_t> const& values, int32_t lit) {
+    int8_t v = values[size_t(std::abs(lit))];
+    return lit > 0 ? v : int8_t(-v);
+  }
+
+  void assign(std::vector<int8_t> &values, int32_t lit) {
+    values[size_t(std::abs(lit))] = lit > 0 ? 1 : -1;
+  }
+
+  bool dpll(stub_solver const& s, std::vector<int8_t> &values) {
+    // unit propagation, looking for the first unsatisfied clause
+    int32_t branch = 0;
+    bool changed = true;
+    while(changed) {
+      changed = false;
+      branch = 0;
+      for(auto const& c : s.clauses) {
+        size_t unassigned = 0;
+        int32_t last = 0;
+        bool sat = false;
+        for(int32_t lit : c) {
+          int8_t v = value(values, lit);
+          if(v > 0) {
+            sat = true;
+            break;
+          }
+          if(v == 0) {
+            ++unassigned;
+            last = lit;
+          }
+        }
+        if(sat)
+          continue;
+        if(unassigned == 0)
+          return false;
+        if(unassigned == 1) {
+          assign(values, last);
+          changed = true;
+        } else if(branch == 0)
+          branch = last;
+      }
+    }
+
+    if(branch == 0)
+      return true;
+
+    for(int32_t lit : {branch, -branch}) {
+      std::vector<int8_t> copy = values;
+      assign(copy, lit);
+      if(dpll(s, copy)) {
+        values = copy;
+        return true;
+      }
+    }
+
+    return false;
+  }
+}
+
+extern "C" {
+
+  const char *ipasir_signature() {
+    return "black-ipasir-stub";
+  }
+
+  void *ipasir_init() {
+    return new stub_solver;
+  }
+
+  void ipasir_release(void *solver) {
+    delete static_cast<stub_solver *>(solver);
+  }
+
+  void ipasir_add(void *solver, int32_t lit) {
+    stub_solver *s = static_cast<stub_solver *>(solver);
+    if(lit == 0) {
+      s->clauses.push_back(s->clause);
+      s->clause.clear();
+      return;
+    }
+    s->clause.push_back(lit);
+    s->maxvar = std::max(s->maxvar, std::abs(lit));
+  }
+
+  void ipasir_assume(void *solver, int32_t lit) {
+    stub_solver *s = static_cast<stub_solver *>(solver);
+    s->assumptions.push_back(lit);
+    s->maxvar = std::max(s->maxvar, std::abs(lit));
+  }
+
+  int ipasir_solve(void *solver) {
+    stub_solver *s = static_cast<stub_solver *>(solver);
+    std::vector<int8_t> values(size_t(s->maxvar) + 1, 0);
+    
+    bool sat = true;
+    for(int32_t lit : s->assumptions) {
+      if(value(values, lit) < 0)
+        sat = false;
+      assign(values, lit);
+    }
+    s->assumptions.clear();
+
+    sat = sat && dpll(*s, values);
+    s->model = values;
+
+    return sat ? 10 : 20;
+  }
+
+  int32_t ipasir_val(void *solver, int32_t lit) {
+    stub_solver *s = static_cast<stub_solver *>(solver);
+    size_t var = size_t(std::abs(lit));
+    
+    // unconstrained variables are set to false
+    int8_t v = var < s->model.size() ? s->model[var] : 0;
+    bool truth = (v > 0) == (lit > 0);
+
+    return truth ? lit : -lit;
+  }
+
+}
@@ -73,4 +73,84 @@ TEST_CASE("CNF Translation")
       REQUIRE(!s.solve());
     }
   }
+
+  SECTION("Polarity-aware CNF of random formulas") {
+    for(formula f : tests) 
+    { 
+      cnf full = to_cnf(f);
+      cnf pg = to_cnf(f, cnf_encoding::plaisted_greenbaum);
+      formula fc = to_formula(sigma, pg);
+
+      INFO("Formula: " << f)
+      INFO("CNF: " << fc)
+      REQUIRE(pg.size() <= full.size());
+
+      s.set_formula(!implies(fc,f));
+      REQUIRE(!s.solve());
+      
+      s.set_formula(f);
+      tribool sat_f = s.solve();
+      s.set_formula(fc);
+      REQUIRE(s.solve() == sat_f);
+    }
+  }
+
+  SECTION("N-ary definitions for chains of conjunctions and disjunctions") {
+    std::vector<atom> atoms;
+    for(std::string sym : symbols)
+      atoms.push_back(sigma.var(sym));
+
+    formula conj = big_and(sigma, atoms, [](atom a) { return a; });
+    formula disj = big_or(sigma, atoms, [](atom a) { return !a; });
+
+    // n binary clauses, one n+1-ary clause, and the unit clause
+    REQUIRE(to_cnf(conj).size() == atoms.size() + 2);
+
+    // the same, plus the definitions of the negated atoms
+    REQUIRE(to_cnf(disj).size() == 3 * atoms.size() + 2);
+  }
+}
+
+TEST_CASE("Flat CNF representation")
+{
+  alphabet sigma;
+
+  atom p = sigma.var("p");
+  atom q = sigma.var("q");
+
+  SECTION("Packed literals") {
+    literal lp = {true, p};
+    literal lq = {false, q};
+
+    REQUIRE(lp.sign());
+    REQUIRE(!lq.sign());
+    REQUIRE(lp.atom(sigma) == p);
+    REQUIRE(lq.atom(sigma) == q);
+    REQUIRE(lp.atom_id() == p.unique_id());
+
+    REQUIRE((!lp).atom(sigma) == p);
+    REQUIRE(!(!lp).sign());
+    REQUIRE((!(!lp)) == lp);
+    REQUIRE(lp != lq);
+  }
+
+  SECTION("Clauses as views over the literals") {
+    cnf c = {{{true, p}, {false, q}}, {}, {{false, p}}};
+
+    REQUIRE(c.size() == 3);
+    REQUIRE(c.literals().size() == 3);
+    REQUIRE(c[0].size() == 2);
+    REQUIRE(c[1].empty());
+    REQUIRE(c[2][0] == literal{false, p});
+
+    size_t n = 0;
+    for(clause cl : c)
+      n += cl.size();
+    REQUIRE(n == 3);
+
+    c.push_literal({true, q});
+    c.end_clause();
+    REQUIRE(c.size() == 4);
+    REQUIRE(to_formula(sigma, c[3]) == q);
+  }
 }
@@ -108,3 +108,45 @@ TEST_CASE("Translation for basic past formulas")
     }
   }
 }
+
+TEST_CASE("Translation of shared past subformulas")
+{
+  alphabet sigma;
+
+  atom p = sigma.var("p");
+  atom q = sigma.var("q");
+
+  atom p_Y  = sigma.var(internal::past_label{Y(p)});
+  atom p_S  = sigma.var(internal::past_label{S(p,q)});
+  atom p_YS = sigma.var(internal::past_label{Y(p_S)});
+
+  formula sem_Y = !p_Y && G(iff(X(p_Y), p));
+  formula sem_S = G(iff(p_S, q || (p && p_YS)));
+  formula sem_YS = !p_YS && G(iff(X(p_YS), p_S));
+
+  std::vector<test> tests = {
+      {Y(p) && X(Y(p)),    (p_Y && X(p_Y)) && sem_Y},
+      {F(Y(p)) && G(Y(p)), (F(p_Y) && G(p_Y)) && sem_Y},
+      {S(p,q) && Y(S(p,q)), ((p_S && p_YS) && sem_S) && sem_YS},
+      {Y(S(p,q)) && S(p,q), ((p_YS && p_S) && sem_YS) && sem_S}
+  };
+
+  for(test t : tests) {
+    DYNAMIC_SECTION("Translation for formula: " << t.formula) {
+      CHECK(remove_past(t.formula) == t.result);
+    }
+  }
+
+  SECTION("Translation produces an equisatisfiable formula") {
+    black::solver slv;
+
+    for(test t : tests) {
+      DYNAMIC_SECTION("Check for formula: " << t.formula) {
+        slv.set_formula(
+          formula{!implies(remove_past(t.formula), t.formula)}
+        );
+        CHECK(!slv.solve()); // check validity
+      }
+    }
+  }
+}
@@ -25,10 +25,32 @@
 #include <black/solver/solver.hpp>
 #include <black/sat/solver.hpp>
 #include <black/sat/dimacs.hpp>
+#include <black/support/config.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <black/sat/backends/recorder.hpp>
+
+#ifdef BLACK_IPASIR_BACKEND
+  #include <black/sat/backends/ipasir.hpp>
+#endif
 
 TEST_CASE("SAT backends") {
 
-  std::vector<std::string> backends = {"z3", "mathsat", "cmsat", "minisat"};
+  std::vector<std::string> backends = {
+    "z3", "mathsat", "cmsat", "minisat", "cdcl", "ipasir-stub"
+  };
+
+#ifdef BLACK_IPASIR_STUB
+  if(!black::sat::solver::backend_exists("ipasir-stub"))
+    black::sat::backends::ipasir::register_backend(
+      "ipasir-stub", BLACK_IPASIR_STUB
+    );
+#endif
 
   black::alphabet sigma;
   auto p = sigma.var("p");
@@ -56,8 +78,368 @@ TEST_CASE("SAT backends") {
         
         REQUIRE(slv->is_sat());
         REQUIRE(slv->value(p) == false);
+
+        slv->clear();
+        slv->assert_formula(p || q);
+
+        REQUIRE(slv->is_sat_with(!p));
+        REQUIRE(slv->value(q) == true);
+        REQUIRE(!slv->is_sat_with(!p && !q));
+        REQUIRE(slv->is_sat_with(!p));
+        REQUIRE(slv->is_sat_with(!q));
+        REQUIRE(slv->value(p) == true);
+        REQUIRE(slv->is_sat());
+
+        if(auto *dimacs = dynamic_cast<black::sat::dimacs::solver*>(slv.get())){
+          dimacs->clear();
+          dimacs->set_cnf_encoding(black::cnf_encoding::plaisted_greenbaum);
+          dimacs->assert_formula(!(p && q));
+
+          REQUIRE(dimacs->is_sat_with(p || q));
+          REQUIRE(!dimacs->is_sat_with(p && q));
+
+          // variables mapped by assert_formula() are frozen automatically
+          dimacs->clear();
+          dimacs->enable_elimination();
+          dimacs->assert_formula(p || q);
+          REQUIRE(dimacs->is_sat_with(!p));
+          dimacs->assert_formula(!q);
+          REQUIRE(!dimacs->is_sat_with(!p));
+          REQUIRE(dimacs->is_sat());
+          REQUIRE(dimacs->value(p) == true);
+
+          // eliminated variables still get a value in the model
+          dimacs->clear();
+          dimacs->enable_elimination();
+          dimacs->new_vars(3);
+          dimacs->freeze(1);
+          dimacs->assert_clause({{{true, 1}, {true, 2}}});
+          dimacs->assert_clause({{{false, 2}, {true, 3}}});
+          REQUIRE(dimacs->is_sat());
+          dimacs->assert_clause({{{false, 1}}});
+          REQUIRE(dimacs->is_sat());
+          REQUIRE(dimacs->value(2) == true);
+          REQUIRE(dimacs->value(3) == true);
+        }
       }
     }
   }
   
 }
+
+TEST_CASE("SAT backend options") {
+  using namespace black::sat;
+
+  std::map<std::string, std::vector<std::string>> supported = {
+    {"z3", {"threads", "seed", "memory"}},
+    {"mathsat", {}},
+    {"cmsat", {"threads"}},
+    {"minisat", {"seed"}},
+    {"cdcl", {}}
+  };
+
+  black::alphabet sigma;
+  auto p = sigma.var("p");
+  auto q = sigma.var("q");
+
+  for(auto const& [backend, names] : supported) {
+    if(!solver::backend_exists(backend))
+      continue;
+
+    DYNAMIC_SECTION("SAT backend: " << backend) {
+      auto slv = solver::get_solver(backend);
+      
+      REQUIRE(!slv->set_option("unknown", int64_t{1}));
+      for(std::string name : {"threads", "seed", "memory"}) {
+        bool expected = 
+          std::find(names.begin(), names.end(), name) != names.end();
+
+        int64_t value = name == "memory" ? 1024 : 2;
+
+        INFO("Option: " << name);
+        REQUIRE(!slv->set_option(name, std::string{"2"}));
+        REQUIRE(!slv->set_option(name, int64_t{-1}));
+        REQUIRE(slv->set_option(name, value) == expected);
+      }
+
+      slv->assert_formula(p && !q);
+      REQUIRE(slv->is_sat());
+      REQUIRE(slv->value(p) == true);
+
+      // options that need a fresh solver are refused after asserting
+      // something, and the asserted formulas are kept
+      if(backend == "cmsat") {
+        REQUIRE(!slv->set_option("threads", int64_t{4}));
+        REQUIRE(!slv->is_sat_with(!p));
+      }
+
+      black::solver bslv;
+      bslv.set_sat_backend(backend);
+      bslv.set_sat_option("threads", int64_t{2});
+      bslv.set_sat_option("seed", int64_t{42});
+      bslv.set_formula(X(p) && F(!p));
+      REQUIRE(bslv.solve());
+    }
+  }
+}
+
+TEST_CASE("DIMACS parser") {
+  using namespace black::sat;
+
+  std::vector<std::string> errors;
+  auto handler = [&](std::string error) { errors.push_back(error); };
+
+  SECTION("Flat clause store") {
+    std::string input = 
+      "c comment\n"
+      "p cnf 4 3\n"
+      "1 -2 0 c trailing comment\n"
+      "\t-3\n 4 0\n"
+      "0\n";
+    
+    std::optional<dimacs::problem> p = 
+      dimacs::parse(input.data(), input.data() + input.size(), handler);
+
+    REQUIRE(p.has_value());
+    REQUIRE(errors.empty());
+    REQUIRE(p->size() == 3);
+    REQUIRE(p->nvars == 4);
+    REQUIRE(p->literals.size() == 4);
+    REQUIRE(p->ends == std::vector<size_t>{2, 4, 4});
+    REQUIRE(p->literals[1].var == 2);
+    REQUIRE(!p->literals[1].sign);
+    REQUIRE((*p)[1].size() == 2);
+    REQUIRE((*p)[1][0].var == 3);
+    REQUIRE((*p)[2].size() == 0);
+  }
+
+  SECTION("Streams and files") {
+    std::string input = "p cnf 2 2\n1 2 0\n-1 0\n";
+    
+    std::istringstream str{input};
+    std::optional<dimacs::problem> p1 = dimacs::parse(str, handler);
+
+    std::string path = 
+      (std::filesystem::temp_directory_path() / "black-parser-test.cnf");
+    std::ofstream{path} << input;
+    std::optional<dimacs::problem> p2 = dimacs::parse_file(path, handler);
+    std::filesystem::remove(path);
+
+    REQUIRE(errors.empty());
+    REQUIRE(p1.has_value());
+    REQUIRE(p2.has_value());
+    REQUIRE(p1->ends == p2->ends);
+    REQUIRE(p1->nvars == p2->nvars);
+    REQUIRE(p2->size() == 2);
+
+    REQUIRE(!dimacs::parse_file("/nonexistent/problem.cnf", handler));
+    REQUIRE(errors.size() == 1);
+  }
+
+  SECTION("Syntax errors") {
+    std::vector<std::pair<std::string, std::string>> tests = {
+      {"p cnf\n", "expected nbvars and nbclauses in problem header"},
+      {"1 2 0\n", "expected problem header"},
+      {"p cnf 2 1\n1 2", "expected '0' at the end of clause"},
+      {"p cnf 2 1\n1 a 0", "expected literal"},
+      {"p cnf 2 1\n1 99999999999 0", "expected literal"},
+    };
+
+    for(auto [input, error] : tests) {
+      errors.clear();
+      std::istringstream str{input};
+      dimacs::parse(str, handler);
+
+      INFO("Input: " << input);
+      REQUIRE(errors == std::vector<std::string>{error});
+    }
+  }
+}
+
+TEST_CASE("Incremental DIMACS problems") {
+  using namespace black::sat;
+
+  auto handler = [](std::string) { REQUIRE(false); };
+
+  std::string input = 
+    "p inccnf\n"
+    "1 2 0\n"
+    "a -1 0\n"
+    "-2 0\n"
+    "a 0\n"
+    "a -1 0\n";
+
+  std::optional<dimacs::problem> p = 
+    dimacs::parse(input.data(), input.data() + input.size(), handler);
+
+  REQUIRE(p.has_value());
+  REQUIRE(p->incremental);
+  REQUIRE(p->size() == 2);
+  REQUIRE(p->queries.size() == 3);
+  REQUIRE(p->queries[0].nclauses == 1);
+  REQUIRE(p->queries[0].assumptions.size() == 1);
+  REQUIRE(p->queries[1].nclauses == 2);
+  REQUIRE(p->queries[1].assumptions.empty());
+  REQUIRE(p->queries[2].nclauses == 2);
+
+  std::stringstream printed;
+  dimacs::print(printed, *p);
+  std::optional<dimacs::problem> p2 = dimacs::parse(printed, handler);
+  REQUIRE(p2.has_value());
+  REQUIRE(p2->ends == p->ends);
+  REQUIRE(p2->queries.size() == p->queries.size());
+
+  std::vector<std::string> backends = {"z3", "mathsat", "minisat", "cdcl"};
+
+  for(auto backend : backends) {
+    if(!solver::backend_exists(backend))
+      continue;
+
+    DYNAMIC_SECTION("SAT backend: " << backend) {
+      std::vector<bool> expected = {true, true, false};
+      REQUIRE(dimacs::replay(*p, backend) == expected);
+
+      std::string name = "recorder-" + backend;
+      std::string path = 
+        std::filesystem::temp_directory_path() / (name + ".icnf");
+      
+      REQUIRE(
+        !backends::recorder::register_backend(name, backend, path)
+      );
+      REQUIRE(backends::recorder::register_backend(name, backend, path));
+      REQUIRE(backends::recorder::register_backend("r", "foo", path));
+
+      black::alphabet sigma;
+      auto a = sigma.var("a");
+      auto b = sigma.var("b");
+      {
+        auto slv = solver::get_solver(name);
+        slv->assert_formula(a || b);
+        REQUIRE(slv->is_sat_with(!a));
+        REQUIRE(slv->value(b) == true);
+        slv->assert_formula(!b);
+        REQUIRE(slv->is_sat());
+        REQUIRE(!slv->is_sat_with(!a));
+      }
+
+      std::optional<dimacs::problem> recorded = 
+        dimacs::parse_file(path, handler);
+      std::filesystem::remove(path);
+
+      REQUIRE(recorded.has_value());
+      REQUIRE(recorded->incremental);
+      REQUIRE(recorded->queries.size() == 3);
+      REQUIRE(dimacs::replay(*recorded, backend) == expected);
+      REQUIRE(!backends::recorder::error(path));
+
+      // the file of the second session cannot be opened
+      std::filesystem::remove_all(path + ".1");
+      std::filesystem::create_directory(path + ".1");
+      {
+        auto slv = solver::get_solver(name);
+        slv->assert_formula(a);
+        REQUIRE(slv->is_sat());
+      }
+      std::filesystem::remove(path);
+      std::filesystem::remove(path + ".1");
+
+      REQUIRE(backends::recorder::error(path).has_value());
+    }
+  }
+}
+
+TEST_CASE("Solving DIMACS problems") {
+  using namespace black::sat;
+
+  std::vector<std::string> backends = {
+    "z3", "mathsat", "cmsat", "minisat", "cdcl"
+  };
+
+  std::string sat = "p cnf 3 4\n1 2 0\n-1 3 0\n-2 -3 0\n-3 0\n";
+  std::string unsat = sat + "-2 0\n";
+
+  auto handler = [](std::string) { REQUIRE(false); };
+  std::optional<dimacs::problem> psat = 
+    dimacs::parse(sat.data(), sat.data() + sat.size(), handler);
+  std::optional<dimacs::problem> punsat = 
+    dimacs::parse(unsat.data(), unsat.data() + unsat.size(), handler);
+  REQUIRE(psat.has_value());
+  REQUIRE(punsat.has_value());
+
+  for(auto backend : backends) {
+    if(!solver::backend_exists(backend))
+      continue;
+
+    DYNAMIC_SECTION("SAT backend: " << backend) {
+      std::optional<dimacs::solution> s = dimacs::solve(*psat, backend);
+      
+      REQUIRE(s.has_value());
+      REQUIRE(s->assignments.size() == 3);
+      for(dimacs::literal l : s->assignments)
+        REQUIRE(l.sign == (l.var == 2));
+
+      REQUIRE(!dimacs::solve(*punsat, backend).has_value());
+    }
+  }
+}
+
+TEST_CASE("SAT backends registry") {
+  using black::sat::solver;
+
+  // backends built as modules are listed before being loaded
+  std::vector<std::string_view> backends = solver::backends();
+  REQUIRE(!backends.empty());
+
+  std::sort(backends.begin(), backends.end());
+  REQUIRE(
+    std::adjacent_find(backends.begin(), backends.end()) == backends.end()
+  );
+
+  for(auto name : backends) {
+    REQUIRE(solver::backend_exists(name));
+    REQUIRE(solver::get_solver(name) != nullptr);
+  }
+
+  REQUIRE(solver::backend_exists(BLACK_DEFAULT_BACKEND));
+  REQUIRE(!solver::backend_exists("nonexistent"));
+}
+
+#ifdef BLACK_IPASIR_STUB
+TEST_CASE("IPASIR backend") {
+  using black::sat::backends::ipasir;
+
+  SECTION("Loading errors") {
+    REQUIRE(ipasir::register_backend("missing", "/nonexistent/libipasir.so"));
+    REQUIRE(!black::sat::solver::backend_exists("missing"));
+
+    REQUIRE(ipasir::register_backend("z3", BLACK_IPASIR_STUB));
+  }
+
+  SECTION("Registration under a runtime name") {
+    REQUIRE(!ipasir::register_backend("ipasir-test", BLACK_IPASIR_STUB));
+    REQUIRE(black::sat::solver::backend_exists("ipasir-test"));
+    REQUIRE(ipasir::register_backend("ipasir-test", BLACK_IPASIR_STUB));
+
+    auto backends = black::sat::solver::backends();
+    REQUIRE(
+      std::find(backends.begin(), backends.end(), "ipasir-test") != 
+      backends.end()
+    );
+
+    ipasir slv{BLACK_IPASIR_STUB};
+    REQUIRE(slv.signature() == "black-ipasir-stub");
+    REQUIRE(!slv.license());
+
+    slv.new_vars(2);
+    slv.assert_clause({{{true, 1}, {true, 2}}});
+    slv.assert_clause({{{false, 1}}});
+    
+    REQUIRE(slv.is_sat());
+    REQUIRE(slv.value(1) == false);
+    REQUIRE(slv.value(2) == true);
+    REQUIRE(slv.value(3) == black::tribool::undef);
+    REQUIRE(!slv.is_sat_with({{false, 2}}));
+    REQUIRE(slv.is_sat());
+  }
+}
+#endif
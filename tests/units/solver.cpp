@@ -25,7 +25,14 @@
 
 #include <black/support/config.hpp>
 #include <black/logic/formula.hpp>
+#include <black/logic/parser.hpp>
 #include <black/solver/solver.hpp>
+#include <black/sat/solver.hpp>
+#include <black/internal/debug/random_formula.hpp>
+
+#ifdef BLACK_IPASIR_BACKEND
+  #include <black/sat/backends/ipasir.hpp>
+#endif
 
 using namespace black;
 
@@ -54,3 +61,90 @@ TEST_CASE("Testing solver")
     REQUIRE(!slv.model().has_value());
   }
 }
+
+TEST_CASE("Clause-level encoding for DIMACS backends")
+{
+  alphabet sigma;
+  std::mt19937 gen((std::random_device())());
+
+  std::vector<std::string> symbols = {"p1", "p2", "p3", "p4", "p5"};
+
+  std::vector<formula> tests;
+  for(int i = 0; i < 30; ++i)
+    tests.push_back(random_ltlp_formula(gen, sigma, 8, symbols));
+
+  std::vector<std::string> backends = {
+    "minisat", "cmsat", "cdcl", "ipasir-stub"
+  };
+
+#ifdef BLACK_IPASIR_STUB
+  if(!black::sat::solver::backend_exists("ipasir-stub"))
+    black::sat::backends::ipasir::register_backend(
+      "ipasir-stub", BLACK_IPASIR_STUB
+    );
+#endif
+
+  for(auto backend : backends) {
+    if(!black::sat::solver::backend_exists(backend))
+      continue;
+
+    DYNAMIC_SECTION("Backend: " << backend) {
+      for(bool finite : {false, true}) {
+        for(auto encoding : 
+            {cnf_encoding::tseitin, cnf_encoding::plaisted_greenbaum}) 
+        {
+          for(formula f : tests) {
+            black::solver expected, actual;
+            actual.set_sat_backend(backend);
+            actual.set_cnf_encoding(encoding);
+
+            expected.set_formula(f, finite);
+            actual.set_formula(f, finite);
+
+            INFO("Formula: " << to_string(f))
+            INFO("Finite: " << finite)
+            INFO("Polarity-aware: " << 
+                 (encoding == cnf_encoding::plaisted_greenbaum))
+            REQUIRE(expected.solve(10) == actual.solve(10));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Bulk model extraction")
+{
+  alphabet sigma;
+  auto p = sigma.var("p");
+  auto q = sigma.var("q");
+  auto r = sigma.var("r");
+
+  formula f = G(F(p)) && X(X(q && !p)) && G(implies(q, Y(!r)));
+
+  for(std::string backend : {"z3", "minisat", "cmsat", "cdcl"}) {
+    if(!black::sat::solver::backend_exists(backend))
+      continue;
+
+    for(bool finite : {false, true}) {
+      DYNAMIC_SECTION("Backend: " << backend << ", finite: " << finite) {
+        black::solver slv;
+        slv.set_sat_backend(backend);
+        slv.set_formula(f, finite);
+        REQUIRE(slv.solve() == true);
+
+        auto model = slv.model();
+        REQUIRE(model.has_value());
+
+        auto m = model->extract({p, q, r});
+        REQUIRE(m.size == model->size());
+        REQUIRE(m.loop == model->loop());
+        REQUIRE(m.atoms == std::vector<atom>{p, q, r});
+        REQUIRE(m.values.size() == 3 * m.size);
+        for(size_t i = 0; i < m.atoms.size(); ++i)
+          for(size_t t = 0; t < m.size; ++t)
+            REQUIRE(m.value(i, t) == model->value(m.atoms[i], t));
+      }
+    }
+  }
+}
@@ -0,0 +1,259 @@
+//
+// BLACK - Bounded Ltl sAtisfiability ChecKer
+//
+// (C) 2019 Nicola Gigante
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <catch2/catch.hpp>
+
+#include <black/logic/formula.hpp>
+#include <black/logic/alphabet.hpp>
+#include <black/logic/parser.hpp>
+#include <black/solver/solver.hpp>
+#include <black/trace/trace.hpp>
+#include <black/trace/checker.hpp>
+#include <black/trace/monitor.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace black;
+
+TEST_CASE("Trace representation")
+{
+  black::trace t;
+  
+  size_t p = t.intern("p");
+  size_t q = t.intern("q");
+  REQUIRE(p != q);
+  REQUIRE(t.intern("p") == p);
+  REQUIRE(t.index("q") == q);
+  REQUIRE(!t.index("r").has_value());
+
+  for(size_t i = 0; i < 100; ++i) {
+    REQUIRE(t.push_state() == i);
+    t.set(p, i, i % 3 == 0);
+    if(i % 2)
+      t.set(q, i, tribool::undef);
+  }
+
+  REQUIRE(t.size() == 100);
+  for(size_t i = 0; i < 100; ++i) {
+    REQUIRE(t.value(p, i) == (i % 3 == 0));
+    REQUIRE(t.value(q, i) == tribool::undef);
+  }
+
+  auto [known, value] = t.word(p, 1);
+  REQUIRE(known == ~uint64_t{0} >> 28);
+  REQUIRE((value & 1) == (64 % 3 == 0));
+  REQUIRE(t.word(q, 0) == std::pair<uint64_t, uint64_t>{0, 0});
+}
+
+TEST_CASE("Trace checking of models")
+{
+  std::vector<std::string> tests = {
+    "G F p && F G !q",
+    "G(p -> wX !p) && G F p",
+    "p U (q && Y p)",
+    "G(q -> O p) && F q && !p",
+    "F(p && Y(!p S q)) && G(p -> Z !p)",
+    "(p W q) && X(!q R p) && H !r",
+    "G(p <-> X X !p) && F(q T p)",
+    "F(p && X(q && X(r && Y Y p)))",
+  };
+
+  for(bool finite : {false, true}) {
+    for(std::string const&s : tests) {
+      DYNAMIC_SECTION("Formula: " << s << ", finite: " << finite) {
+        alphabet sigma;
+        auto f = parse_formula(sigma, s);
+        REQUIRE(f.has_value());
+
+        black::solver slv;
+        slv.set_formula(*f, finite);
+        REQUIRE(slv.solve() == true);
+
+        auto model = slv.model();
+        REQUIRE(model.has_value());
+
+        black::trace t;
+        t.loop = finite ? model->size() : model->loop();
+        for(size_t i = 0; i < model->size(); ++i) {
+          t.push_state();
+          for(std::string name : {"p", "q", "r"})
+            t.set(t.intern(name), i, model->value(sigma.var(name), i));
+        }
+
+        trace_checker checker{t, finite};
+        REQUIRE(checker.check(*f));
+        REQUIRE(!checker.check(!*f));
+      }
+    }
+  }
+}
+
+TEST_CASE("Trace checking of past formulas on the loop")
+{
+  alphabet sigma;
+  atom p = sigma.var("p");
+
+  // p holds only at the first state, then the trace loops on !p
+  black::trace t;
+  t.loop = 1;
+  t.set(t.intern("p"), t.push_state(), true);
+  t.set(t.intern("p"), t.push_state(), false);
+
+  trace_checker checker{t, false};
+  REQUIRE(checker.check(X(Y(p))));
+  REQUIRE(!checker.check(X(X(Y(p)))));
+  REQUIRE(checker.check(G(O(p))));
+  REQUIRE(!checker.check(F(Y(Y(p))), 3));
+  REQUIRE(checker.check(F(p), 0));
+  REQUIRE(!checker.check(F(p), 5));
+}
+
+TEST_CASE("Trace checking of shared past subformulas")
+{
+  alphabet sigma;
+  formula f = sigma.var("p");
+
+  // f is a DAG with 28 levels of sharing, that holds only at position 28
+  for(size_t i = 0; i < 28; ++i)
+    f = Y(f) && O(f);
+
+  black::trace t;
+  t.loop = 1;
+  t.set(t.intern("p"), t.push_state(), true);
+  t.set(t.intern("p"), t.push_state(), false);
+
+  trace_checker checker{t, false};
+  REQUIRE(checker.check(f, 28));
+  REQUIRE(!checker.check(f, 27));
+  REQUIRE(!checker.check(f, 29));
+}
+
+TEST_CASE("Trace checking of more formulas at once")
+{
+  alphabet sigma;
+  atom p = sigma.var("p");
+  atom q = sigma.var("q");
+
+  // p alternates, q holds from the second state on
+  black::trace t;
+  t.loop = 2;
+  for(size_t i = 0; i < 4; ++i) {
+    t.push_state();
+    t.set(t.intern("p"), i, i % 2 == 0);
+    t.set(t.intern("q"), i, i > 0);
+  }
+
+  std::vector<formula> fs = {
+    G(F(p)), G(F(p)) && F(q), Y(p) || G(F(p)), G(F(p)) && G(q), X(H(q))
+  };
+
+  trace_checker checker{t, false};
+  std::vector<bool> values = checker.check(fs);
+  REQUIRE(values == std::vector<bool>{true, true, true, false, false});
+
+  for(size_t i = 0; i < fs.size(); ++i) {
+    trace_checker single{t, false};
+    REQUIRE(single.check(fs[i], 1) == checker.check(fs, 1)[i]);
+  }
+}
+
+TEST_CASE("Online monitoring")
+{
+  std::vector<std::string> tests = {
+    "p",
+    "p S q",
+    "!(p T (q || r)) && Y H p",
+    "X p && Y q",
+    "wX wX (p <-> Z q)",
+    "O(p && X(q S Y r)) -> wX(H !q)",
+    "X(p S X X q) || (Y p && wX r)",
+  };
+
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int> values{0, 5};
+
+  for(std::string const&s : tests) {
+    DYNAMIC_SECTION("Formula: " << s) {
+      alphabet sigma;
+      auto f = parse_formula(sigma, s);
+      REQUIRE(f.has_value());
+      REQUIRE(!monitor::monitorable(*f).has_value());
+
+      for(size_t size = 1; size < 20; ++size) {
+        black::trace t;
+        t.loop = size;
+        monitor mon{*f};
+        std::vector<bool> verdicts;
+
+        for(size_t i = 0; i < size; ++i) {
+          t.push_state();
+          std::vector<tribool> state;
+          for(atom a : mon.atoms()) {
+            int v = values(gen);
+            tribool value = v == 0 ? tribool::undef : tribool{v % 2 == 0};
+            t.set(t.intern(to_string(a)), i, value);
+            state.push_back(value);
+          }
+          if(auto verdict = mon.step(state); verdict)
+            verdicts.push_back(*verdict);
+        }
+
+        for(bool verdict : mon.finish())
+          verdicts.push_back(verdict);
+
+        REQUIRE(verdicts.size() == size);
+        
+        trace_checker checker{t, true};
+        for(size_t i = 0; i < size; ++i)
+          REQUIRE(verdicts[i] == checker.check(*f, i));
+      }
+    }
+  }
+
+  SECTION("Shared subformulas") {
+    alphabet sigma;
+    formula f = sigma.var("p");
+    for(size_t i = 0; i < 64; ++i)
+      f = Y(f) || wX(f);
+
+    REQUIRE(!monitor::monitorable(f).has_value());
+    REQUIRE(monitor::monitorable(f && F(f)).has_value());
+
+    monitor mon{f};
+    REQUIRE(mon.delay() == 64);
+    REQUIRE(mon.atoms().size() == 1);
+  }
+
+  SECTION("Unbounded future operators") {
+    alphabet sigma;
+    atom p = sigma.var("p");
+    atom q = sigma.var("q");
+
+    REQUIRE(monitor::monitorable(Y(p) && X(O(q))) == std::nullopt);
+    REQUIRE(monitor::monitorable(p && F(q)).has_value());
+    REQUIRE(monitor::monitorable(O(U(p, q))).has_value());
+  }
+}